@@ -48,15 +48,19 @@ static void drawStats(void);
 #define explosionFrameHeight 32
 #define explosionFrames      14
 #define explosionFPS         42
+#define explosionClip        0
 
 static const SoundChannel explosionChannel1 = SoundChannel2;
 static const SoundChannel explosionChannel2 = SoundChannel3;
 
+#define debrisParticles  12
+#define debrisLifetimeMs 600
+
 static int explosionSprite = -1;
+static int debrisEmitter   = -1;
 
 static void initializeExplosions(void);
 static void spawnExplosion(const f16 xPosition, const f16 yPosition);
-static void updateExplosion(const int entityIndex);
 
 // Waves ----------------------------------------------------------------------
 
@@ -160,21 +164,25 @@ static void drawStats(void) {
 
 static void initializeExplosions(void) {
     explosionSprite = GetSprite(&ExplosionImage, 0, explosionFrameWidth, explosionFrameHeight);
-    ConfigureSprite(explosionSprite, explosionFrames, explosionFPS);
+    SetSpriteClip(explosionSprite, explosionClip, 0, explosionFrames, explosionFPS, ClipOnce);
+    SetSpriteClipFinish(explosionSprite, explosionClip, ClipFinishRelease, 0);
+
+    SetActiveLayer(layerEffects);
+    debrisEmitter = GetEmitter(0, 0);
+    SetEmitterLifetime(debrisEmitter, debrisLifetimeMs);
+    SetEmitterVelocity(debrisEmitter, 0, -F16(1), F16(2), F16(2));
+    SetEmitterGravity(debrisEmitter, 0, F16Half / 4);
+    SetEmitterColors(debrisEmitter, GetColorIndex(255, 128, 0), 8);
 }
 
 static void spawnExplosion(const f16 xPosition, const f16 yPosition) {
-    GetEntity(typeIDExplosion, explosionSprite, xPosition, yPosition);
+    SetEntityClip(GetEntity(typeIDExplosion, explosionSprite, xPosition, yPosition), explosionClip);
+    SetEmitterPosition(debrisEmitter, xPosition + F16(explosionFrameWidth / 2), yPosition + F16(explosionFrameHeight / 2));
+    EmitParticles(debrisEmitter, debrisParticles);
     PlayTone(explosionChannel1, TriangleWave, 330, 200);
     PlayTone(explosionChannel2, SawtoothWave, 220, 300);
 }
 
-static void updateExplosion(const int entityIndex) {
-    if (GetEntityFrameIndex(entityIndex) >= F16(explosionFrames - 1)) {
-        ReleaseEntity(entityIndex);
-    }
-}
-
 // Implementation: Waves ------------------------------------------------------
 
 static void initializeWaves(void) {
@@ -221,6 +229,7 @@ static void resetEnemy(const int entityIndex) {
 static void initializeEnemies(void) {
     enemySprite = GetSprite(&EnemyImage, 0, enemyFrameWidth, enemyFrameHeight);
     ConfigureSprite(enemySprite, enemyFrames, enemyFPS);
+    SetSpriteCollisionMask(enemySprite, true);
 
     SetActiveLayer(layerPlayfield);
     for (uint enemyIndex = 0; enemyIndex < numberOfEnemies; enemyIndex++) {
@@ -249,13 +258,6 @@ static void initializeProjectiles(void) {
 }
 
 static void updateProjectile(const int entityIndex) {
-    f16 projectileY = GetEntityPositionY(entityIndex);
-
-    if (projectileY <= 0) {
-        ReleaseEntity(entityIndex);
-        return;
-    }
-
     int enemyIndex = GetCollidingEntityIndex(entityIndex, typeIDEnemy);
 
     if (enemyIndex >= 0) {
@@ -274,13 +276,6 @@ static void updateProjectile(const int entityIndex) {
 }
 
 static void updateEnemyProjectile(const int entityIndex) {
-    f16 projectileY = GetEntityPositionY(entityIndex);
-
-    if (projectileY > F16(ScreenHeight)) {
-        ReleaseEntity(entityIndex);
-        return;
-    }
-
     int playerIndex = GetCollidingEntityIndex(entityIndex, typeIDPlayer);
 
     if (playerIndex >= 0) {
@@ -301,6 +296,8 @@ static void spawnProjectile(const uint typeID, const f16 xPosition, const f16 yP
 
     SetEntitySpeed(projectileEntity, 0, F16(projectileSpeed));
     SetEntityDirection(projectileEntity, 0, typeID == typeIDProjectile ? -1 : 1);
+    SetEntityBehaviors(projectileEntity, BehaviorReleaseOffscreen | BehaviorContinuous);
+    SetEntityCollisionType(projectileEntity, typeID == typeIDProjectile ? typeIDEnemy : typeIDPlayer);
 
     if (typeID == typeIDProjectile) {
         PlayTone(projectileChannel, SawtoothWave, 880, 100);
@@ -312,6 +309,7 @@ static void spawnProjectile(const uint typeID, const f16 xPosition, const f16 yP
 static void initializePlayer(void) {
     playerSprite = GetSprite(&PlaneImage, 0, playerFrameWidth, playerFrameHeight);
     ConfigureSprite(playerSprite, playerFrames, playerFPS);
+    SetSpriteCollisionMask(playerSprite, true);
 
     SetActiveLayer(layerPlayfield);
     playerEntity = GetEntity(typeIDPlayer, playerSprite, F16((ScreenWidth - playerFrameWidth) / 2), F16(ScreenHeight - playerFrameHeight - 2));
@@ -354,9 +352,9 @@ static void updateEntities() {
     }
 
     SetActiveLayer(layerPlayfield);
-    uint numberOfEntities = GetNumberOfEntities();
+    uint entityIndexLimit = GetEntityIndexLimit();
 
-    for (uint entityIndex = 0; entityIndex < numberOfEntities; entityIndex++) {
+    for (uint entityIndex = 0; entityIndex < entityIndexLimit; entityIndex++) {
         switch (GetEntityTypeID(entityIndex)) {
             case typeIDPlayer: {
                 if (currentHealth > 0) {
@@ -382,20 +380,11 @@ static void updateEntities() {
             }
         }
     }
-
-    SetActiveLayer(layerEffects);
-    numberOfEntities = GetNumberOfEntities();
-
-    for (uint entityIndex = 0; entityIndex < numberOfEntities; entityIndex++) {
-        updateExplosion(entityIndex);
-    }
 }
 
 static void inGame(const f16 speedMultiplier) {
     SetActiveLayer(layerPlayfield);
 
-    playerEntity = FindEntityIndex(typeIDPlayer, 1);
-
     if (IsButtonJustPressed(ButtonY)) {
         spawnProjectile(typeIDProjectile,
                         GetEntityPositionX(playerEntity) + F16(playerFrameWidth / 2),
@@ -28,13 +28,19 @@ void DrvCpuWaitMessage(const u8 coreIndex, void* messageData);
 
 // Display --------------------------------------------------------------------
 
+#define MaxDisplayRegions 8    // Most changed regions of the framebuffer a display sync can be given.
+
 bool DrvDisplayInitialize(void);
 void DrvDisplayFinalize(void);
 
 void DrvDisplaySetColorPallete(const u8* colorPalette);
-u64  DrvDisplaySync(const u8* framebufferData);
+u64  DrvDisplaySync(const u8* framebufferData, const LineEffect* lineEffects);
+u64  DrvDisplaySyncLines(const u8* framebufferData, const u32 firstRow, const u32 numberOfRows);
+u64  DrvDisplaySyncRegions(const u8* framebufferData, const Rectangle2D* regions, const u32 numberOfRegions);
 u64  DrvDisplayGetTime(void);
 
+const u8* DrvDisplayGetFrame(void);    // The frame the display shows, as last given to it, without line effects.
+
 // GPIO -----------------------------------------------------------------------
 
 typedef enum GpioMode {
@@ -69,12 +75,27 @@ u64  DrvGpuGetTime(void);
 void DrvGpuSetTransparentColor(const u16 colorIndex);
 void DrvGpuSetBackgroundColor(const u16 colorIndex);
 void DrvGpuSetForegroundColor(const u16 colorIndex);
+void DrvGpuSetLineEffects(const LineEffect* lineEffects, const i32 firstRow, const i32 numberOfRows);
+void DrvGpuSetScreenRemap(const u8* remapTable);
+void DrvGpuSetDrawRemap(const u8* remapTable);
+void DrvGpuSetDeferred(const bool isEnabled);
+bool DrvGpuBeginCache(const u8 cacheIndex);
+void DrvGpuEndCache(const u8 cacheIndex);
+void DrvGpuInvalidateCaches(const void* data, const u32 size);
 
-u8 DrvGpuGetNearestColorIndex(const u8 redValue, const u8 greenValue, const u8 blueValue);
+u8   DrvGpuGetNearestColorIndex(const u8 redValue, const u8 greenValue, const u8 blueValue);
+void DrvGpuGetColor(const u8 colorIndex, u8* redValue, u8* greenValue, u8* blueValue);
 
 void DrvGpuDraw(const Image* image, const Point2D* position, const Rectangle2D* clipRect);
 void DrvGpuDrawScaled(const Image* image, const Rectangle2D* sourceRect, const Rectangle2D* targetRect);
+void DrvGpuDrawAffine(const Image* image, const Rectangle2D* sourceRect, const Point2D* position, const FixedPoint2D* pivot, const FixedMatrix2D* matrix);
+void DrvGpuDrawTileMapLines(const TileMap* tileMap, const ScanlineTransform* lineTransforms, const i32 firstRow, const i32 numberOfRows);
 void DrvGpuDrawRectangle(const Rectangle2D* rectangle, const u8 colorIndex);
+void DrvGpuDrawPixel(const Point2D* position, const u8 colorIndex);
+void DrvGpuDrawFrame(const Image* image, const Rectangle2D* frameRect, const Point2D* position, const u16 frameTransparentColor);
+
+u32  DrvGpuEncodeSpans(const Image* image, const Rectangle2D* frameRect, const u16 frameTransparentColor, u16* spanWords, const u32 maxWords);
+void DrvGpuDrawSpans(const Image* image, const Rectangle2D* frameRect, const u16* spanWords, const Point2D* position, const u16 frameTransparentColor);
 
 // Input ----------------------------------------------------------------------
 
@@ -128,14 +128,22 @@ void finalizeDisplay(void) {
 #define blitHeight (displayHeight / blitRows)
 #define blitPixels (blitWidth * blitHeight)
 
-static u16 blitBuffer[blitPixels];
-static u8  localFrameBuffer[ScreenPixels];
-static u16 displayColorPalette[ScreenColors * 3];
-static u8  coreIndex;
+static u16        blitBuffer[blitPixels];
+static u8         localFrameBuffer[ScreenPixels];
+static LineEffect localLineEffects[ScreenHeight];
+static bool       hasLineEffects = false;
+static u16        displayColorPalette[ScreenColors * 3];
+static u8         coreIndex;
 
 static u64 lastSyncTick = 0;
 static u64 busyTime     = 0;
 
+typedef struct syncMessage {
+        u8 readyRows;                        // Framebuffer rows of the frame that can be sent.
+        u8 numberOfRegions;                  // When not zero, only these regions of the frame are sent.
+        u8 regions[MaxDisplayRegions][4];    // X, Y, width and height of each region, in framebuffer pixels.
+} syncMessage;
+
 static inline u16 toDisplayColor(const u8* color) {
     // RRRRR GGGGGG BBBBB
     u16 displayColor = ((color[0] >> 3) << 11) |
@@ -149,13 +157,33 @@ static inline void fillBlitBuffer(const u32 startY) {
     static u32 pixelIndex;
     static u16 pixelColor;
     static u32 lineStart;
+    static u32 sourceX;
+    static i32 sourceY;
+    static u8  colorOffset;
 
     for (u16 pixelY = 0; pixelY < blitHeight / 2; pixelY++) {
-        lineStart = ((startY + pixelY) * ScreenWidth);
+        sourceY     = startY + pixelY;
+        sourceX     = 0;
+        colorOffset = 0;
+
+        if (hasLineEffects) {
+            const LineEffect* lineEffect = &localLineEffects[startY + pixelY];
+
+            sourceY     = sourceY + lineEffect->RowOffset;
+            sourceY     = sourceY < 0 ? 0 : (sourceY >= ScreenHeight ? ScreenHeight - 1 : sourceY);
+            sourceX     = ((-lineEffect->ScrollX % ScreenWidth) + ScreenWidth) % ScreenWidth;
+            colorOffset = lineEffect->ColorOffset;
+        }
+
+        lineStart = (sourceY * ScreenWidth);
 
         for (u16 pixelX = 0; pixelX < ScreenWidth; pixelX++) {
-            pixelIndex = lineStart + pixelX;
-            pixelColor = displayColorPalette[localFrameBuffer[pixelIndex]];
+            pixelIndex = lineStart + sourceX;
+            pixelColor = displayColorPalette[(u8) (localFrameBuffer[pixelIndex] + colorOffset)];
+
+            if (++sourceX == ScreenWidth) {
+                sourceX = 0;
+            }
 
             blitBuffer[(pixelY * 2 * blitWidth) + (pixelX * 2)]           = pixelColor;
             blitBuffer[(pixelY * 2 * blitWidth) + (pixelX * 2 + 1)]       = pixelColor;
@@ -165,16 +193,80 @@ static inline void fillBlitBuffer(const u32 startY) {
     }
 }
 
+static inline void fillRegionBuffer(const u32 startX, const u32 startY, const u32 regionWidth, const u32 numberOfRows) {
+    u32 blitStride = regionWidth * 2;
+
+    for (u32 pixelY = 0; pixelY < numberOfRows; pixelY++) {
+        const u8* sourceRow = &localFrameBuffer[((startY + pixelY) * ScreenWidth) + startX];
+        u16*      targetRow = &blitBuffer[pixelY * 2 * blitStride];
+
+        for (u32 pixelX = 0; pixelX < regionWidth; pixelX++) {
+            u16 pixelColor = displayColorPalette[sourceRow[pixelX]];
+
+            targetRow[(pixelX * 2)]                  = pixelColor;
+            targetRow[(pixelX * 2) + 1]              = pixelColor;
+            targetRow[blitStride + (pixelX * 2)]     = pixelColor;
+            targetRow[blitStride + (pixelX * 2) + 1] = pixelColor;
+        }
+    }
+}
+
+static void sendRegion(const u8* region) {
+    u32 regionX      = region[0];
+    u32 regionY      = region[1];
+    u32 regionWidth  = region[2];
+    u32 regionHeight = region[3];
+    u32 chunkRows    = blitPixels / (regionWidth * 4);
+
+    DrvSerialWait(serialPortNumber);
+
+    setAddress(regionX * 2, regionY * 2, ((regionX + regionWidth) * 2) - 1, ((regionY + regionHeight) * 2) - 1);
+    sendCommand(cmdWriteMemory);
+
+    for (u32 rowIndex = 0; rowIndex < regionHeight; rowIndex += chunkRows) {
+        u32 numberOfRows = regionHeight - rowIndex < chunkRows ? regionHeight - rowIndex : chunkRows;
+
+        DrvSerialWait(serialPortNumber);
+        fillRegionBuffer(regionX, regionY + rowIndex, regionWidth, numberOfRows);
+
+        DrvSerialWrite(serialPortNumber, numberOfRows * regionWidth * 8, (u8*) blitBuffer);
+    }
+}
+
 void syncCore(void) {
+    // Every message carries how many framebuffer rows of the frame are ready. Whole frames come as a
+    // single message, while frames synced in lines come as one message per strip of rows.
+
+    syncMessage message;
+    bool        hasDroppedFrame = false;
+
     for (;;) {
-        DrvCpuWaitMessage(coreIndex, NULL);
+        DrvCpuWaitMessage(coreIndex, &message);
 
         u64 startTime = DrvCpuGetTick();
 
-        if (startTime - lastSyncTick > TargetFrameTime) {
+        // Frames with regions are never dropped, since their regions are not sent again. After a dropped
+        // frame they are sent whole instead, as the display is missing the changes of the dropped frame.
+
+        if (message.numberOfRegions && !hasDroppedFrame) {
+            for (u8 regionIndex = 0; regionIndex < message.numberOfRegions; regionIndex++) {
+                sendRegion(message.regions[regionIndex]);
+            }
+
+            busyTime = DrvCpuGetTick() - startTime;
+            continue;
+        }
+
+        // Late whole frames are dropped, but frames synced in lines are always sent, since their
+        // remaining rows are still on the queue.
+
+        if (!message.numberOfRegions && message.readyRows == ScreenHeight && startTime - lastSyncTick > TargetFrameTime) {
+            hasDroppedFrame = true;
             continue;
         }
 
+        hasDroppedFrame = false;
+
         DrvSerialWait(serialPortNumber);
 
         setAddress(0, 0, displayWidth - 1, displayHeight - 1);
@@ -183,6 +275,10 @@ void syncCore(void) {
         u16 pixelY = 0;
 
         for (u8 rowIndex = 0; rowIndex < blitRows; rowIndex++) {
+            while (message.readyRows < pixelY + blitHeight / 2) {
+                DrvCpuWaitMessage(coreIndex, &message);
+            }
+
             DrvSerialWait(serialPortNumber);
             fillBlitBuffer(pixelY);
             pixelY += blitHeight / 2;
@@ -209,7 +305,7 @@ bool DrvDisplayInitialize(void) {
 
     coreIndex = DrvCpuGetAvailableCoreIndex();
 
-    if ((coreIndex == 0) || !DrvCpuRunCore(coreIndex, 1, 10, syncCore)) {
+    if ((coreIndex == 0) || !DrvCpuRunCore(coreIndex, sizeof(syncMessage), 16, syncCore)) {
         finalizeDisplay();
         return false;
     }
@@ -228,16 +324,83 @@ void DrvDisplaySetColorPallete(const u8* colorPalette) {
     }
 }
 
-u64 DrvDisplaySync(const u8* framebufferData) {
+u64 DrvDisplaySync(const u8* framebufferData, const LineEffect* lineEffects) {
     lastSyncTick = DrvCpuGetTick();
 
     memcpy(&localFrameBuffer, framebufferData, ScreenPixels);
 
-    DrvCpuSendMessage(coreIndex, NULL);
+    hasLineEffects = lineEffects != NULL;
+
+    if (hasLineEffects) {
+        memcpy(localLineEffects, lineEffects, sizeof(localLineEffects));
+    }
+
+    syncMessage message = {.readyRows = ScreenHeight, .numberOfRegions = 0};
+    DrvCpuSendMessage(coreIndex, &message);
+
+    return busyTime;
+}
+
+u64 DrvDisplaySyncLines(const u8* framebufferData, const u32 firstRow, const u32 numberOfRows) {
+    u32 endRow = firstRow + numberOfRows > ScreenHeight ? ScreenHeight : firstRow + numberOfRows;
+
+    if (firstRow >= endRow) {
+        return busyTime;
+    }
+
+    if (firstRow == 0) {
+        lastSyncTick   = DrvCpuGetTick();
+        hasLineEffects = false;
+    }
+
+    // The rows are sent as soon as they are copied, while the rows after them are still being drawn.
+
+    memcpy(&localFrameBuffer[firstRow * ScreenWidth], &framebufferData[firstRow * ScreenWidth], (endRow - firstRow) * ScreenWidth);
+
+    syncMessage message = {.readyRows = endRow, .numberOfRegions = 0};
+    DrvCpuSendMessage(coreIndex, &message);
+
+    return busyTime;
+}
+
+u64 DrvDisplaySyncRegions(const u8* framebufferData, const Rectangle2D* regions, const u32 numberOfRegions) {
+    syncMessage message = {.readyRows = ScreenHeight, .numberOfRegions = 0};
+
+    lastSyncTick   = DrvCpuGetTick();
+    hasLineEffects = false;
+
+    // Only the regions are copied, the rest of the local framebuffer already holds what the display shows.
+
+    for (u32 regionIndex = 0; regionIndex < numberOfRegions && regionIndex < MaxDisplayRegions; regionIndex++) {
+        const Rectangle2D* region = &regions[regionIndex];
+
+        if (region->X < 0 || region->Y < 0 || region->Width <= 0 || region->Height <= 0 ||
+            region->X + region->Width > ScreenWidth || region->Y + region->Height > ScreenHeight) {
+            continue;
+        }
+
+        for (i32 rowIndex = region->Y; rowIndex < region->Y + region->Height; rowIndex++) {
+            memcpy(&localFrameBuffer[(rowIndex * ScreenWidth) + region->X], &framebufferData[(rowIndex * ScreenWidth) + region->X], region->Width);
+        }
+
+        message.regions[message.numberOfRegions][0] = region->X;
+        message.regions[message.numberOfRegions][1] = region->Y;
+        message.regions[message.numberOfRegions][2] = region->Width;
+        message.regions[message.numberOfRegions][3] = region->Height;
+        message.numberOfRegions++;
+    }
+
+    if (message.numberOfRegions) {
+        DrvCpuSendMessage(coreIndex, &message);
+    }
 
     return busyTime;
 }
 
+const u8* DrvDisplayGetFrame(void) {
+    return localFrameBuffer;
+}
+
 u64 DrvDisplayGetTime(void) {
     return busyTime;
 }
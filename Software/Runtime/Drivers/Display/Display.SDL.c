@@ -23,6 +23,7 @@ static SDL_Rect     sdlWindowRect    = {0, 0, displayWidth* windowScale, display
 
 static u64 busyTime = 0;
 static u8  localColorPallete[ScreenColors * 3];
+static u8  localFrameBuffer[ScreenPixels];    // What the window shows, so the GPU only sends what changed.
 
 // Driver ---------------------------------------------------------------------
 
@@ -79,8 +80,9 @@ void DrvDisplaySetColorPallete(const u8* colorPalette) {
     memcpy(localColorPallete, colorPalette, ScreenColors * 3);
 }
 
-u64 DrvDisplaySync(const u8* framebufferData) {
-    u64 startTime = DrvCpuGetTick();
+// Converts the rows in [firstRow, endRow) of the framebuffer to the blit surface.
+
+static void convertLines(const u8* framebufferData, const LineEffect* lineEffects, const u32 firstRow, const u32 endRow) {
     SDL_LockSurface(sdlBlitSurface);
 
     u8* surfacePixels = sdlBlitSurface->pixels;
@@ -88,10 +90,28 @@ u64 DrvDisplaySync(const u8* framebufferData) {
 
     u32 sourceOffset, targetOffset;
 
-    for (u16 pixelY = 0; pixelY < ScreenHeight; pixelY++) {
+    for (u16 pixelY = firstRow; pixelY < endRow; pixelY++) {
+        i32 sourceY     = pixelY;
+        u32 sourceX     = 0;
+        u8  colorOffset = 0;
+
+        // Line effects only change where the row is read from and its color offset, so they cost a few
+        // operations per row on top of the conversion that runs anyway.
+
+        if (lineEffects) {
+            sourceY     = pixelY + lineEffects[pixelY].RowOffset;
+            sourceY     = sourceY < 0 ? 0 : (sourceY >= ScreenHeight ? ScreenHeight - 1 : sourceY);
+            sourceX     = ((-lineEffects[pixelY].ScrollX % ScreenWidth) + ScreenWidth) % ScreenWidth;
+            colorOffset = lineEffects[pixelY].ColorOffset;
+        }
+
         for (u16 pixelX = 0; pixelX < ScreenWidth; pixelX++) {
-            sourceOffset = (pixelY * ScreenWidth) + pixelX;
-            colorIndex   = framebufferData[sourceOffset];
+            sourceOffset = (sourceY * ScreenWidth) + sourceX;
+            colorIndex   = framebufferData[sourceOffset] + colorOffset;
+
+            if (++sourceX == ScreenWidth) {
+                sourceX = 0;
+            }
 
             targetOffset = (pixelY * sdlBlitSurface->pitch) + (pixelX * 3);
 
@@ -102,14 +122,73 @@ u64 DrvDisplaySync(const u8* framebufferData) {
     }
 
     SDL_UnlockSurface(sdlBlitSurface);
+}
 
+static void presentFrame(void) {
     SDL_BlitScaled(sdlBlitSurface, NULL, sdlWindowSurface, &sdlWindowRect);
     SDL_UpdateWindowSurface(sdlWindow);
+}
+
+u64 DrvDisplaySync(const u8* framebufferData, const LineEffect* lineEffects) {
+    u64 startTime = DrvCpuGetTick();
+
+    memcpy(localFrameBuffer, framebufferData, ScreenPixels);
+    convertLines(framebufferData, lineEffects, 0, ScreenHeight);
+    presentFrame();
 
     busyTime = DrvCpuGetTick() - startTime;
     return busyTime;
 }
 
+u64 DrvDisplaySyncLines(const u8* framebufferData, const u32 firstRow, const u32 numberOfRows) {
+    u64 startTime = DrvCpuGetTick();
+    u32 endRow    = firstRow + numberOfRows > ScreenHeight ? ScreenHeight : firstRow + numberOfRows;
+
+    if (firstRow >= endRow) {
+        return busyTime;
+    }
+
+    if (firstRow == 0) {
+        busyTime = 0;
+    }
+
+    // The window is only updated once the last rows of the frame arrive.
+
+    memcpy(&localFrameBuffer[firstRow * ScreenWidth], &framebufferData[firstRow * ScreenWidth], (endRow - firstRow) * ScreenWidth);
+    convertLines(framebufferData, NULL, firstRow, endRow);
+
+    if (endRow == ScreenHeight) {
+        presentFrame();
+    }
+
+    busyTime += DrvCpuGetTick() - startTime;
+    return busyTime;
+}
+
+u64 DrvDisplaySyncRegions(const u8* framebufferData, const Rectangle2D* regions, const u32 numberOfRegions) {
+    u64 startTime = DrvCpuGetTick();
+
+    // Whole rows of every region are converted, which is simpler and about as fast on the desktop.
+
+    for (u32 regionIndex = 0; regionIndex < numberOfRegions; regionIndex++) {
+        const Rectangle2D* region = &regions[regionIndex];
+
+        memcpy(&localFrameBuffer[region->Y * ScreenWidth], &framebufferData[region->Y * ScreenWidth], region->Height * ScreenWidth);
+        convertLines(framebufferData, NULL, region->Y, region->Y + region->Height);
+    }
+
+    if (numberOfRegions) {
+        presentFrame();
+    }
+
+    busyTime = DrvCpuGetTick() - startTime;
+    return busyTime;
+}
+
+const u8* DrvDisplayGetFrame(void) {
+    return localFrameBuffer;
+}
+
 u64 DrvDisplayGetTime(void) {
     return busyTime;
 }
\ No newline at end of file
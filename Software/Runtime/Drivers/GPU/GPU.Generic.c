@@ -7,316 +7,1507 @@
 
 #include "../../Drivers.h"
 
+#define ColorLutBits 4    // A 4K table, small enough to keep in RAM and fill lazily on the device.
+
+#include "../../Palette.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 // GPU ------------------------------------------------------------------------
 
-static u8  framebuffer[ScreenPixels];
-static u8  colorPalette[ScreenColors * 3];
-static u16 transparentColor = ColorNone;
-static u16 backgroundColor  = ColorNone;
-static u16 foregroundColor  = ColorNone;
-static u64 lastBusyTime     = 0;
-static u64 busyTime         = 0;
-
-static void buildColorPalette(void) {
-    static const u8 minValues[48] = {
-        0, 0, 0,      // While/Gray/Black
-        32, 0, 0,     // Red
-        32, 8, 0,     // Red/Orange
-        32, 16, 0,    // Orange
-        32, 16, 0,    // Orange/Yellow
-        32, 32, 0,    // Yellow
-        16, 32, 0,    // Lime
-        0, 32, 0,     // Green
-        0, 32, 16,    // Green/Teal
-        0, 32, 32,    // Teal
-        0, 16, 32,    // Teal/Blue
-        0, 0, 32,     // Blue
-        8, 0, 32,     // Blue/Purple
-        16, 0, 32,    // Purple
-        32, 0, 32,    // Fuchsia
-        32, 0, 16,    // Fuchsia/Red
-    };
+#define maxRemapTables 4    // The identity plus the draw remaps a deferred frame can hold before it is flushed.
+
+static u8         framebuffer[ScreenPixels];
+static u8         colorPalette[ScreenColors * 3];
+static u8         colorLut[ColorLutSize];
+static u32        colorLutEntries[ColorLutSize / 32];
+static LineEffect lineEffects[ScreenHeight];
+static u8         screenRemap[ScreenColors];
+static u8         remapTables[maxRemapTables][ScreenColors];
+static const u8*  drawRemap        = remapTables[0];
+static u32        usedRemapTables  = 1;
+static bool       hasLineEffects   = false;
+static bool       hasDrawRemap     = false;
+static u16        transparentColor = ColorNone;
+static u16        backgroundColor  = ColorNone;
+static u16        foregroundColor  = ColorNone;
+static i32        clipTop          = 0;               // Draws only touch the rows in [clipTop, clipBottom), which
+static i32        clipBottom       = ScreenHeight;    // is the whole screen unless a deferred strip is drawn.
+static u64        lastBusyTime     = 0;
+static u64        busyTime         = 0;
 
-    static const u8 midValues[48] = {
-        128, 128, 128,    // While/Gray/Black
-        255, 0, 0,        // Red
-        255, 64, 0,       // Red/Orange
-        255, 128, 0,      // Orange
-        255, 192, 0,      // Orange/Yellow
-        255, 255, 0,      // Yellow
-        128, 255, 0,      // Lime
-        0, 255, 0,        // Green
-        0, 255, 128,      // Green/Teal
-        0, 255, 255,      // Teal
-        0, 128, 255,      // Teal/Blue
-        0, 0, 255,        // Blue
-        64, 0, 255,       // Blue/Purple
-        128, 0, 255,      // Purple
-        255, 0, 255,      // Fuchsia
-        255, 0, 128,      // Fuchsia/Red
-    };
+#define startTimer() u64 startTime = DrvCpuGetTick()
+#define stopTimer()  busyTime += DrvCpuGetTick() - startTime
+
+// Copies the pixels of a row that are not keyColor, a vector (or 32-bit word) at a time.
+
+static void copyKeyedRow(u8* targetRow, const u8* sourceRow, const u32 rowWidth, const u8 keyColor) {
+    u32 pixelX = 0;
+
+#if defined(__AVX2__)
+    __m256i keyVector = _mm256_set1_epi8(keyColor);
+
+    for (; pixelX + 32 <= rowWidth; pixelX += 32) {
+        __m256i sourcePixels = _mm256_loadu_si256((const __m256i*) &sourceRow[pixelX]);
+        __m256i targetPixels = _mm256_loadu_si256((const __m256i*) &targetRow[pixelX]);
+        __m256i keyMask      = _mm256_cmpeq_epi8(sourcePixels, keyVector);
+
+        _mm256_storeu_si256((__m256i*) &targetRow[pixelX], _mm256_blendv_epi8(sourcePixels, targetPixels, keyMask));
+    }
+#elif defined(__SSE2__)
+    __m128i keyVector = _mm_set1_epi8(keyColor);
+
+    for (; pixelX + 16 <= rowWidth; pixelX += 16) {
+        __m128i sourcePixels = _mm_loadu_si128((const __m128i*) &sourceRow[pixelX]);
+        __m128i targetPixels = _mm_loadu_si128((const __m128i*) &targetRow[pixelX]);
+        __m128i keyMask      = _mm_cmpeq_epi8(sourcePixels, keyVector);
+
+        _mm_storeu_si128((__m128i*) &targetRow[pixelX], _mm_or_si128(_mm_and_si128(keyMask, targetPixels), _mm_andnot_si128(keyMask, sourcePixels)));
+    }
+#else
+    u32 keyWord = keyColor * 0x01010101u;
+
+    for (; pixelX + 4 <= rowWidth; pixelX += 4) {
+        u32 sourceWord;
+        memcpy(&sourceWord, &sourceRow[pixelX], 4);
+
+        // High bit of each byte set when that byte differs from the key, then widened to a full byte mask.
+
+        u32 differentBits = sourceWord ^ keyWord;
+        u32 opaqueBits    = (((differentBits & 0x7F7F7F7Fu) + 0x7F7F7F7Fu) | differentBits) & 0x80808080u;
+        u32 opaqueMask    = (opaqueBits >> 7) * 0xFF;
+
+        if (opaqueMask == 0) {
+            continue;
+        }
+
+        if (opaqueMask != 0xFFFFFFFFu) {
+            u32 targetWord;
+            memcpy(&targetWord, &targetRow[pixelX], 4);
+            sourceWord = (sourceWord & opaqueMask) | (targetWord & ~opaqueMask);
+        }
+
+        memcpy(&targetRow[pixelX], &sourceWord, 4);
+    }
+#endif
+
+    for (; pixelX < rowWidth; pixelX++) {
+        if (sourceRow[pixelX] != keyColor) {
+            targetRow[pixelX] = sourceRow[pixelX];
+        }
+    }
+}
+
+// Copies a row with the transparent, background and foreground overrides and the draw remap applied per pixel.
+
+static void copyOverrideRow(u8* targetRow, const u8* sourceRow, const u32 rowWidth, const u16 keyColor) {
+    for (u32 pixelX = 0; pixelX < rowWidth; pixelX++) {
+        u8 pixelColor = sourceRow[pixelX];
+
+        if (pixelColor == keyColor) {
+            if (backgroundColor == ColorNone) {
+                continue;
+            }
+
+            pixelColor = backgroundColor;
+        } else if (foregroundColor != ColorNone) {
+            pixelColor = foregroundColor;
+        }
+
+        targetRow[pixelX] = drawRemap[pixelColor];
+    }
+}
+
+static void copyRows(u8* targetRow, const u8* sourceRow, const u32 sourceStride, const u32 rowWidth, const u32 numberOfRows, const u16 keyColor) {
+    for (u32 rowIndex = 0; rowIndex < numberOfRows; rowIndex++) {
+        if (backgroundColor != ColorNone || foregroundColor != ColorNone || hasDrawRemap) {
+            copyOverrideRow(targetRow, sourceRow, rowWidth, keyColor);
+        } else if (keyColor >= ScreenColors) {
+            memcpy(targetRow, sourceRow, rowWidth);
+        } else {
+            copyKeyedRow(targetRow, sourceRow, rowWidth, keyColor);
+        }
+
+        sourceRow += sourceStride;
+        targetRow += ScreenWidth;
+    }
+}
+
+// Deferred -------------------------------------------------------------------
+
+// In deferred mode draw calls are recorded during the frame and rasterized at sync one strip of rows at a
+// time, so each strip can go to the display while the next one is drawn. The strips match the blit rows
+// of the ILI9341 driver (12 strips of 10 framebuffer rows). Recorded draws keep pointing at their image,
+// span and tile data, which must stay unchanged until the frame is synced.
+
+#define deferredStripRows 10
+#define deferredStrips    (ScreenHeight / deferredStripRows)
+
+#ifndef MaxDrawCommands
+    #define MaxDrawCommands 128    // Draws recorded before the list is flushed to the whole framebuffer.
+#endif
+
+#ifndef MaxDeferredLines
+    #define MaxDeferredLines (ScreenHeight * 2)    // Tile map line transforms kept for the recorded draws.
+#endif
+
+#define drawCommandClear     0
+#define drawCommandImage     1
+#define drawCommandFrame     2
+#define drawCommandSpans     3
+#define drawCommandScaled    4
+#define drawCommandAffine    5
+#define drawCommandTileMap   6
+#define drawCommandRectangle 7
+#define drawCommandPixel     8
+#define drawCommandRestore   9
+#define drawCommandSave      10
+
+typedef struct drawCommand {
+        u8        type;
+        u16       stripMask;
+        u16       transparentColor;
+        u16       backgroundColor;
+        u16       foregroundColor;
+        bool      hasDrawRemap;
+        const u8* drawRemap;
+
+        union {
+            struct {
+                    Image       image;
+                    Rectangle2D sourceRect;
+                    Point2D     position;
+                    u16         keyColor;
+                    const u16*  spanWords;
+            } image;
+
+            struct {
+                    Image       image;
+                    Rectangle2D sourceRect;
+                    Rectangle2D targetRect;
+            } scaled;
+
+            struct {
+                    Image         image;
+                    Rectangle2D   sourceRect;
+                    Point2D       position;
+                    FixedPoint2D  pivot;
+                    FixedMatrix2D matrix;
+            } affine;
+
+            struct {
+                    TileMap tileMap;
+                    Image   tileset;
+                    u16     firstLine;
+                    i32     firstRow;
+                    i32     numberOfRows;
+            } tileMap;
+
+            struct {
+                    Rectangle2D rectangle;
+                    u8          colorIndex;
+            } fill;
+        };
+} drawCommand;
+
+static drawCommand       drawCommands[MaxDrawCommands];
+static ScanlineTransform deferredLines[MaxDeferredLines];
+static u32               numberOfCommands      = 0;
+static u32               numberOfDeferredLines = 0;
+static bool              isDeferred            = false;
+static bool              isRecording           = false;
+
+// Static layers are recorded even in immediate mode, so a layer drawn the same way as the last time can be
+// replaced with the copy of the frame taken after it. The saved draws are kept to tell whether it was.
+
+typedef struct staticLayer {
+        u8                pixels[ScreenPixels];
+        drawCommand       commands[MaxDrawCommands];
+        ScanlineTransform lines[MaxDeferredLines];
+        u8                remaps[maxRemapTables][ScreenColors];
+        u32               numberOfCommands;
+        bool              isValid;
+        bool              isSaving;    // The copy is taken when a deferred frame is drawn.
+} staticLayer;
+
+#if MaxStaticLayers > 0
+static staticLayer staticLayers[MaxStaticLayers];
+#endif
+static u32  drawingLayer      = 0;
+static u32  nextLayer         = 0;
+static u32  layerFirstCommand = 0;
+static u32  layerFirstLine    = 0;
+static bool isDrawingLayer    = false;
+static bool isLayerBroken     = false;    // Part of the layer was flushed, so its draws can't be compared.
+static bool areLayersRestored = true;     // Every layer so far this frame was restored from its copy.
+static bool isFrameDrawn      = false;    // Something besides static layers was drawn this frame.
+
+static void restoreLayer(const u32 layerIndex) {
+#if MaxStaticLayers > 0
+    startTimer();
+
+    memcpy(&framebuffer[clipTop * ScreenWidth], &staticLayers[layerIndex].pixels[clipTop * ScreenWidth], (clipBottom - clipTop) * ScreenWidth);
+
+    stopTimer();
+#endif
+}
+
+static void saveLayer(const u32 layerIndex) {
+#if MaxStaticLayers > 0
+    staticLayer* layer = &staticLayers[layerIndex];
+
+    startTimer();
+
+    memcpy(&layer->pixels[clipTop * ScreenWidth], &framebuffer[clipTop * ScreenWidth], (clipBottom - clipTop) * ScreenWidth);
+
+    stopTimer();
+
+    // The copy is complete once the last strip is drawn, unless the layer was invalidated meanwhile.
+
+    if (clipBottom == ScreenHeight) {
+        layer->isValid  = layer->isSaving;
+        layer->isSaving = false;
+    }
+#endif
+}
+
+// Starts an empty command list. A draw remap in use keeps the first remap slot, since later remaps take
+// the slots after it.
+
+static void resetCommands(void) {
+    numberOfCommands      = 0;
+    numberOfDeferredLines = 0;
+    layerFirstCommand     = 0;
+    layerFirstLine        = 0;
+
+    if (hasDrawRemap && drawRemap != remapTables[1]) {
+        memcpy(remapTables[1], drawRemap, ScreenColors);
+    }
+
+    drawRemap       = hasDrawRemap ? remapTables[1] : remapTables[0];
+    usedRemapTables = hasDrawRemap ? 2 : 1;
+}
+
+static void replayCommands(const u16 stripMask) {
+    u16       currentTransparentColor = transparentColor;
+    u16       currentBackgroundColor  = backgroundColor;
+    u16       currentForegroundColor  = foregroundColor;
+    bool      currentHasDrawRemap     = hasDrawRemap;
+    const u8* currentDrawRemap        = drawRemap;
+    bool      wasFrameDrawn           = isFrameDrawn;
+
+    isRecording = false;
+
+    for (u32 commandIndex = 0; commandIndex < numberOfCommands; commandIndex++) {
+        drawCommand* command = &drawCommands[commandIndex];
+
+        if (!(command->stripMask & stripMask)) {
+            continue;
+        }
+
+        transparentColor = command->transparentColor;
+        backgroundColor  = command->backgroundColor;
+        foregroundColor  = command->foregroundColor;
+        hasDrawRemap     = command->hasDrawRemap;
+        drawRemap        = command->drawRemap;
+
+        switch (command->type) {
+            case drawCommandClear: {
+                DrvGpuClear(command->fill.colorIndex);
+                break;
+            }
+
+            case drawCommandImage: {
+                DrvGpuDraw(&command->image.image, &command->image.position, &command->image.sourceRect);
+                break;
+            }
+
+            case drawCommandFrame: {
+                DrvGpuDrawFrame(&command->image.image, &command->image.sourceRect, &command->image.position, command->image.keyColor);
+                break;
+            }
+
+            case drawCommandSpans: {
+                DrvGpuDrawSpans(&command->image.image, &command->image.sourceRect, command->image.spanWords, &command->image.position, command->image.keyColor);
+                break;
+            }
+
+            case drawCommandScaled: {
+                DrvGpuDrawScaled(&command->scaled.image, &command->scaled.sourceRect, &command->scaled.targetRect);
+                break;
+            }
+
+            case drawCommandAffine: {
+                DrvGpuDrawAffine(&command->affine.image, &command->affine.sourceRect, &command->affine.position, &command->affine.pivot, &command->affine.matrix);
+                break;
+            }
+
+            case drawCommandTileMap: {
+                command->tileMap.tileMap.Tileset = &command->tileMap.tileset;
+                DrvGpuDrawTileMapLines(&command->tileMap.tileMap, &deferredLines[command->tileMap.firstLine], command->tileMap.firstRow, command->tileMap.numberOfRows);
+                break;
+            }
+
+            case drawCommandRectangle: {
+                DrvGpuDrawRectangle(&command->fill.rectangle, command->fill.colorIndex);
+                break;
+            }
+
+            case drawCommandPixel: {
+                Point2D position = {.X = command->fill.rectangle.X, .Y = command->fill.rectangle.Y};
+                DrvGpuDrawPixel(&position, command->fill.colorIndex);
+                break;
+            }
+
+            case drawCommandRestore: {
+                restoreLayer(command->fill.colorIndex);
+                break;
+            }
+
+            case drawCommandSave: {
+                saveLayer(command->fill.colorIndex);
+                break;
+            }
+
+            default: {
+                break;
+            }
+        }
+    }
+
+    transparentColor = currentTransparentColor;
+    backgroundColor  = currentBackgroundColor;
+    foregroundColor  = currentForegroundColor;
+    hasDrawRemap     = currentHasDrawRemap;
+    drawRemap        = currentDrawRemap;
+    isFrameDrawn     = wasFrameDrawn;
+    isRecording      = isDeferred || isDrawingLayer;
+}
+
+// Draws everything recorded so far to the whole framebuffer, used when the command list runs out of room.
+
+static void flushCommands(void) {
+    isLayerBroken |= isDrawingLayer;
+
+    replayCommands(0xFFFF);
+    resetCommands();
+}
 
-    static const u8 maxValues[48] = {
-        255, 255, 255,    // While/Gray/Black
-        255, 224, 224,    // Red
-        255, 224, 224,    // Red/Orange
-        255, 240, 224,    // Orange
-        255, 255, 224,    // Orange/Yellow
-        255, 255, 224,    // Yellow
-        240, 255, 224,    // Lime
-        224, 255, 224,    // Green
-        224, 255, 240,    // Green/Teal
-        224, 255, 255,    // Teal
-        224, 240, 255,    // Teal/Blue
-        224, 224, 255,    // Blue
-        240, 224, 255,    // Blue/Purple
-        240, 224, 255,    // Purple
-        255, 224, 255,    // Fuchsia
-        255, 224, 240,    // Fuchsia/Red
+// Returns a new command covering the rows in [firstRow, endRow), or NULL when they are all off screen.
+
+static drawCommand* recordCommand(const u8 commandType, const i32 firstRow, const i32 endRow) {
+    i32 firstStrip = firstRow < 0 ? 0 : firstRow / deferredStripRows;
+    i32 endStrip   = endRow > ScreenHeight ? deferredStrips : (endRow + deferredStripRows - 1) / deferredStripRows;
+
+    if (firstStrip >= endStrip) {
+        return NULL;
+    }
+
+    if (numberOfCommands == MaxDrawCommands) {
+        flushCommands();
+    }
+
+    drawCommand* command = &drawCommands[numberOfCommands++];
+
+    command->type             = commandType;
+    command->stripMask        = ((1u << endStrip) - 1) & ~((1u << firstStrip) - 1);
+    command->transparentColor = transparentColor;
+    command->backgroundColor  = backgroundColor;
+    command->foregroundColor  = foregroundColor;
+    command->hasDrawRemap     = hasDrawRemap;
+    command->drawRemap        = drawRemap;
+
+    return command;
+}
+
+static void renderStrips(void) {
+    // Row offsets in the line effects can show rows of later strips, so frames with line effects are
+    // only sent once every strip is drawn.
+
+    for (u32 stripIndex = 0; stripIndex < deferredStrips; stripIndex++) {
+        clipTop    = stripIndex * deferredStripRows;
+        clipBottom = clipTop + deferredStripRows;
+
+        replayCommands(1u << stripIndex);
+
+        if (!hasLineEffects) {
+            DrvDisplaySyncLines(framebuffer, clipTop, deferredStripRows);
+        }
+    }
+
+    clipTop    = 0;
+    clipBottom = ScreenHeight;
+
+    if (hasLineEffects) {
+        DrvDisplaySync(framebuffer, lineEffects);
+    }
+
+    resetCommands();
+}
+
+// Static Layers --------------------------------------------------------------
+
+#if MaxStaticLayers > 0
+
+static bool isSameImage(const Image* image, const Image* savedImage) {
+    return image->Width == savedImage->Width && image->Height == savedImage->Height && image->Data == savedImage->Data;
+}
+
+static bool isSameCommand(const drawCommand* command, const drawCommand* savedCommand, const staticLayer* layer) {
+    if (command->type != savedCommand->type || command->stripMask != savedCommand->stripMask || command->transparentColor != savedCommand->transparentColor ||
+        command->backgroundColor != savedCommand->backgroundColor || command->foregroundColor != savedCommand->foregroundColor ||
+        command->hasDrawRemap != savedCommand->hasDrawRemap) {
+        return false;
+    }
+
+    // Remap slots are reused every frame, so the remaps are compared with the copies taken with the layer.
+
+    if (command->hasDrawRemap && memcmp(command->drawRemap, layer->remaps[(savedCommand->drawRemap - remapTables[0]) / ScreenColors], ScreenColors)) {
+        return false;
+    }
+
+    switch (command->type) {
+        case drawCommandClear: {
+            return command->fill.colorIndex == savedCommand->fill.colorIndex;
+        }
+
+        case drawCommandImage:
+        case drawCommandFrame:
+        case drawCommandSpans: {
+            return isSameImage(&command->image.image, &savedCommand->image.image) &&
+                   !memcmp(&command->image.sourceRect, &savedCommand->image.sourceRect, sizeof(Rectangle2D)) &&
+                   !memcmp(&command->image.position, &savedCommand->image.position, sizeof(Point2D)) &&
+                   (command->type == drawCommandImage || command->image.keyColor == savedCommand->image.keyColor) &&
+                   (command->type != drawCommandSpans || command->image.spanWords == savedCommand->image.spanWords);
+        }
+
+        case drawCommandScaled: {
+            return isSameImage(&command->scaled.image, &savedCommand->scaled.image) &&
+                   !memcmp(&command->scaled.sourceRect, &savedCommand->scaled.sourceRect, sizeof(Rectangle2D)) &&
+                   !memcmp(&command->scaled.targetRect, &savedCommand->scaled.targetRect, sizeof(Rectangle2D));
+        }
+
+        case drawCommandAffine: {
+            return isSameImage(&command->affine.image, &savedCommand->affine.image) &&
+                   !memcmp(&command->affine.sourceRect, &savedCommand->affine.sourceRect, sizeof(Rectangle2D)) &&
+                   !memcmp(&command->affine.position, &savedCommand->affine.position, sizeof(Point2D)) &&
+                   !memcmp(&command->affine.pivot, &savedCommand->affine.pivot, sizeof(FixedPoint2D)) &&
+                   !memcmp(&command->affine.matrix, &savedCommand->affine.matrix, sizeof(FixedMatrix2D));
+        }
+
+        case drawCommandTileMap: {
+            const TileMap* tileMap      = &command->tileMap.tileMap;
+            const TileMap* savedTileMap = &savedCommand->tileMap.tileMap;
+
+            return tileMap->TileSize == savedTileMap->TileSize && tileMap->Width == savedTileMap->Width && tileMap->Height == savedTileMap->Height &&
+                   tileMap->Tiles == savedTileMap->Tiles && tileMap->Wrap == savedTileMap->Wrap &&
+                   isSameImage(&command->tileMap.tileset, &savedCommand->tileMap.tileset) &&
+                   command->tileMap.firstRow == savedCommand->tileMap.firstRow && command->tileMap.numberOfRows == savedCommand->tileMap.numberOfRows &&
+                   !memcmp(&deferredLines[command->tileMap.firstLine], &layer->lines[savedCommand->tileMap.firstLine],
+                           command->tileMap.numberOfRows * sizeof(ScanlineTransform));
+        }
+
+        case drawCommandRectangle:
+        case drawCommandPixel: {
+            return !memcmp(&command->fill.rectangle, &savedCommand->fill.rectangle, sizeof(Rectangle2D)) &&
+                   command->fill.colorIndex == savedCommand->fill.colorIndex;
+        }
+
+        default: {
+            return false;
+        }
+    }
+}
+
+// A layer is only restored when every layer under it was too, since its copy holds them as they were then.
+
+static bool isLayerUnchanged(const staticLayer* layer) {
+    u32 numberOfLayerCommands = numberOfCommands - layerFirstCommand;
+
+    if (!layer->isValid || !areLayersRestored || isLayerBroken || numberOfLayerCommands != layer->numberOfCommands) {
+        return false;
+    }
+
+    for (u32 commandIndex = 0; commandIndex < numberOfLayerCommands; commandIndex++) {
+        if (!isSameCommand(&drawCommands[layerFirstCommand + commandIndex], &layer->commands[commandIndex], layer)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void storeLayer(staticLayer* layer) {
+    layer->numberOfCommands = numberOfCommands - layerFirstCommand;
+
+    memcpy(layer->commands, &drawCommands[layerFirstCommand], layer->numberOfCommands * sizeof(drawCommand));
+    memcpy(layer->lines, &deferredLines[layerFirstLine], (numberOfDeferredLines - layerFirstLine) * sizeof(ScanlineTransform));
+    memcpy(layer->remaps, remapTables, sizeof(remapTables));
+
+    for (u32 commandIndex = 0; commandIndex < layer->numberOfCommands; commandIndex++) {
+        if (layer->commands[commandIndex].type == drawCommandTileMap) {
+            layer->commands[commandIndex].tileMap.firstLine -= layerFirstLine;
+        }
+    }
+}
+
+static bool isOverlapping(const void* data, const u32 dataSize, const void* otherData, const u32 otherSize) {
+    return (uintptr_t) data < (uintptr_t) otherData + otherSize && (uintptr_t) otherData < (uintptr_t) data + dataSize;
+}
+
+static bool isImageReading(const Image* image, const void* data, const u32 size) {
+    return isOverlapping(image->Data, (u32) image->Width * image->Height, data, size);
+}
+
+static bool isCommandReading(const drawCommand* command, const void* data, const u32 size) {
+    switch (command->type) {
+        case drawCommandImage:
+        case drawCommandFrame:
+        case drawCommandSpans: {
+            return isImageReading(&command->image.image, data, size);
+        }
+
+        case drawCommandScaled: {
+            return isImageReading(&command->scaled.image, data, size);
+        }
+
+        case drawCommandAffine: {
+            return isImageReading(&command->affine.image, data, size);
+        }
+
+        case drawCommandTileMap: {
+            const TileMap* tileMap = &command->tileMap.tileMap;
+            return isOverlapping(tileMap->Tiles, (u32) tileMap->Width * tileMap->Height, data, size) || isImageReading(&command->tileMap.tileset, data, size);
+        }
+
+        default: {
+            return false;
+        }
+    }
+}
+
+#endif
+
+// Dirty Regions --------------------------------------------------------------
+
+// Frames are compared with the frame the display shows, which its driver keeps, and only the cells of 32x1
+// pixels that differ are sent. Rows that did not change are skipped with a single compare.
+
+#define dirtyCellWidth 32
+#define dirtyColumns   (ScreenWidth / dirtyCellWidth)
+
+static bool isScreenDirty = true;    // The whole frame is sent, after palette changes or frames sent in other ways.
+
+// Fills the regions with runs of rows that have changed cells, each as wide as the changed cells of its rows.
+// Runs past the last region are merged into it. Returns the number of regions.
+
+static u32 findDirtyRegions(const u8* shownFrame, Rectangle2D* regions) {
+    u32 numberOfRegions = 0;
+    u32 firstColumn     = dirtyColumns;
+    u32 endColumn       = 0;
+    i32 firstRow        = -1;
+
+    for (i32 rowIndex = 0; rowIndex <= ScreenHeight; rowIndex++) {
+        u32       rowFirstColumn = dirtyColumns;
+        u32       rowEndColumn   = 0;
+        const u8* rowPixels      = &framebuffer[rowIndex * ScreenWidth];
+        const u8* shownPixels    = &shownFrame[rowIndex * ScreenWidth];
+
+        if (rowIndex < ScreenHeight && memcmp(rowPixels, shownPixels, ScreenWidth) != 0) {
+            for (u32 columnIndex = 0; columnIndex < dirtyColumns; columnIndex++) {
+                if (memcmp(&rowPixels[columnIndex * dirtyCellWidth], &shownPixels[columnIndex * dirtyCellWidth], dirtyCellWidth) != 0) {
+                    rowFirstColumn = columnIndex < rowFirstColumn ? columnIndex : rowFirstColumn;
+                    rowEndColumn   = columnIndex + 1;
+                }
+            }
+        }
+
+        if (rowEndColumn) {
+            firstRow    = firstRow < 0 ? rowIndex : firstRow;
+            firstColumn = rowFirstColumn < firstColumn ? rowFirstColumn : firstColumn;
+            endColumn   = rowEndColumn > endColumn ? rowEndColumn : endColumn;
+            continue;
+        }
+
+        if (firstRow < 0) {
+            continue;
+        }
+
+        Rectangle2D* region = &regions[numberOfRegions];
+
+        if (numberOfRegions == MaxDisplayRegions) {
+            region      = &regions[numberOfRegions - 1];
+            firstRow    = region->Y;
+            firstColumn = region->X / dirtyCellWidth < firstColumn ? region->X / dirtyCellWidth : firstColumn;
+            endColumn   = (region->X + region->Width) / dirtyCellWidth > endColumn ? (region->X + region->Width) / dirtyCellWidth : endColumn;
+        } else {
+            numberOfRegions++;
+        }
+
+        region->X      = firstColumn * dirtyCellWidth;
+        region->Y      = firstRow;
+        region->Width  = (endColumn - firstColumn) * dirtyCellWidth;
+        region->Height = rowIndex - firstRow;
+
+        firstColumn = dirtyColumns;
+        endColumn   = 0;
+        firstRow    = -1;
+    }
+
+    return numberOfRegions;
+}
+
+static void syncDirtyRegions(void) {
+    Rectangle2D regions[MaxDisplayRegions];
+    u32         numberOfRegions = 0;
+    u32         dirtyPixels     = 0;
+
+    startTimer();
+
+    if (!isScreenDirty && !hasLineEffects) {
+        numberOfRegions = findDirtyRegions(DrvDisplayGetFrame(), regions);
+    }
+
+    for (u32 regionIndex = 0; regionIndex < numberOfRegions; regionIndex++) {
+        dirtyPixels += regions[regionIndex].Width * regions[regionIndex].Height;
+    }
+
+    stopTimer();
+
+    // Frames that changed almost everywhere are cheaper to send whole.
+
+    if (isScreenDirty || hasLineEffects || dirtyPixels > (ScreenPixels / 4) * 3) {
+        DrvDisplaySync(framebuffer, hasLineEffects ? lineEffects : NULL);
+    } else {
+        DrvDisplaySyncRegions(framebuffer, regions, numberOfRegions);
+    }
+
+    // The display shows the rows moved by line effects, so the frame after them is sent whole.
+
+    isScreenDirty = hasLineEffects;
+}
+
+// Driver ---------------------------------------------------------------------
+
+bool DrvGpuInitialize(void) {
+    BuildColorPalette(colorPalette);
+    memset(colorLutEntries, 0, sizeof(colorLutEntries));
+    DrvDisplaySetColorPallete(colorPalette);
+    memset(&framebuffer, 0, sizeof(framebuffer));
+    memset(lineEffects, 0, sizeof(lineEffects));
+
+    for (u32 colorIndex = 0; colorIndex < ScreenColors; colorIndex++) {
+        screenRemap[colorIndex]    = colorIndex;
+        remapTables[0][colorIndex] = colorIndex;
+    }
+
+    drawRemap         = remapTables[0];
+    usedRemapTables   = 1;
+    hasLineEffects    = false;
+    hasDrawRemap      = false;
+    numberOfCommands  = 0;
+    isDeferred        = false;
+    isRecording       = false;
+    isScreenDirty     = true;
+    nextLayer         = 0;
+    isDrawingLayer    = false;
+    areLayersRestored = true;
+    isFrameDrawn      = false;
+    busyTime          = 0;
+
+    DrvGpuInvalidateCaches(NULL, 0);
+    return true;
+}
+
+void DrvGpuFinalize(void) {
+    // Empty
+}
+
+void DrvGpuClear(const u8 colorIndex) {
+    isFrameDrawn |= !isDrawingLayer;
+
+    if (isRecording) {
+        // A clear hides everything recorded before it.
+
+        resetCommands();
+        recordCommand(drawCommandClear, 0, ScreenHeight)->fill.colorIndex = colorIndex;
+        return;
+    }
+
+    startTimer();
+
+    memset(&framebuffer[clipTop * ScreenWidth], drawRemap[colorIndex], (clipBottom - clipTop) * ScreenWidth);
+
+    stopTimer();
+}
+
+u64 DrvGpuSync(void) {
+    if (isDrawingLayer) {
+        DrvGpuEndCache(drawingLayer);
+    }
+
+    // Deferred frames are sent strip by strip as they are drawn, so only immediate frames are compared.
+
+    if (isDeferred) {
+        renderStrips();
+        isScreenDirty = true;
+    } else {
+        syncDirtyRegions();
+    }
+
+    nextLayer         = 0;
+    areLayersRestored = true;
+    isFrameDrawn      = false;
+
+    lastBusyTime = busyTime;
+    busyTime     = 0;
+    return lastBusyTime;
+}
+
+u64 DrvGpuGetTime(void) {
+    return lastBusyTime;
+}
+
+void DrvGpuSetTransparentColor(const u16 colorIndex) {
+    transparentColor = colorIndex;
+}
+
+void DrvGpuSetBackgroundColor(const u16 colorIndex) {
+    backgroundColor = colorIndex;
+}
+
+void DrvGpuSetForegroundColor(const u16 colorIndex) {
+    foregroundColor = colorIndex;
+}
+
+// Screen remaps are applied to the palette handed to the display, so they cost nothing per pixel and the
+// display only converts its palette again when the remap actually changes.
+
+void DrvGpuSetScreenRemap(const u8* remapTable) {
+    static u8 remappedPalette[ScreenColors * 3];
+
+    bool hasChanged = false;
+
+    for (u32 colorIndex = 0; colorIndex < ScreenColors; colorIndex++) {
+        u8 remappedIndex = remapTable ? remapTable[colorIndex] : colorIndex;
+
+        hasChanged |= screenRemap[colorIndex] != remappedIndex;
+        screenRemap[colorIndex] = remappedIndex;
+    }
+
+    if (!hasChanged) {
+        return;
+    }
+
+    for (u32 colorIndex = 0; colorIndex < ScreenColors; colorIndex++) {
+        memcpy(&remappedPalette[colorIndex * 3], &colorPalette[screenRemap[colorIndex] * 3], 3);
+    }
+
+    DrvDisplaySetColorPallete(remappedPalette);
+    isScreenDirty = true;
+}
+
+void DrvGpuSetDrawRemap(const u8* remapTable) {
+    if (!remapTable) {
+        drawRemap    = remapTables[0];
+        hasDrawRemap = false;
+        return;
+    }
+
+    // Recorded draws keep pointing at the remap that was set when they were recorded, so every remap
+    // set while recording takes a slot of its own.
+
+    if (isRecording && usedRemapTables == maxRemapTables) {
+        flushCommands();
+    }
+
+    u32 remapSlot = isRecording ? usedRemapTables++ : 1;
+
+    memcpy(remapTables[remapSlot], remapTable, ScreenColors);
+
+    drawRemap    = remapTables[remapSlot];
+    hasDrawRemap = true;
+}
+
+// Static layers are the first draws of a frame, bottom layer first. A layer drawn with the same draws as
+// the last time, reading data that wasn't invalidated since, is replaced with the copy of the frame after it.
+
+bool DrvGpuBeginCache(const u8 cacheIndex) {
+#if MaxStaticLayers > 0
+    if (cacheIndex >= MaxStaticLayers || cacheIndex != nextLayer || isDrawingLayer || isFrameDrawn) {
+        return false;
+    }
+
+    if (!isDeferred) {
+        resetCommands();
+    }
+
+    drawingLayer      = cacheIndex;
+    layerFirstCommand = numberOfCommands;
+    layerFirstLine    = numberOfDeferredLines;
+    isDrawingLayer    = true;
+    isLayerBroken     = false;
+    isRecording       = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void DrvGpuEndCache(const u8 cacheIndex) {
+#if MaxStaticLayers > 0
+    if (!isDrawingLayer || cacheIndex != drawingLayer) {
+        return;
+    }
+
+    staticLayer* layer = &staticLayers[cacheIndex];
+
+    isDrawingLayer = false;
+    nextLayer++;
+
+    if (isLayerUnchanged(layer)) {
+        // Only restored layers were drawn before this one, and its copy replaces them all.
+
+        resetCommands();
+
+        if (isDeferred) {
+            recordCommand(drawCommandRestore, 0, ScreenHeight)->fill.colorIndex = cacheIndex;
+        } else {
+            restoreLayer(cacheIndex);
+        }
+
+        isRecording = isDeferred;
+        return;
+    }
+
+    areLayersRestored = false;
+    layer->isValid    = false;
+    layer->isSaving   = false;
+
+    // The copy is taken when the recorded draws reach it, at sync in deferred mode or right away otherwise.
+
+    if (!isLayerBroken) {
+        storeLayer(layer);
+        layer->isSaving = true;
+        recordCommand(drawCommandSave, 0, ScreenHeight)->fill.colorIndex = cacheIndex;
+    }
+
+    if (!isDeferred) {
+        flushCommands();
+    }
+#endif
+}
+
+// Invalidates the layers that read any of the data given, or every layer when it is NULL.
+
+void DrvGpuInvalidateCaches(const void* data, const u32 size) {
+#if MaxStaticLayers > 0
+    for (u32 layerIndex = 0; layerIndex < MaxStaticLayers; layerIndex++) {
+        staticLayer* layer     = &staticLayers[layerIndex];
+        bool         isReading = !data;
+
+        for (u32 commandIndex = 0; commandIndex < layer->numberOfCommands && !isReading; commandIndex++) {
+            isReading = isCommandReading(&layer->commands[commandIndex], data, size);
+        }
+
+        if (isReading) {
+            layer->isValid  = false;
+            layer->isSaving = false;
+        }
+    }
+#endif
+}
+
+void DrvGpuSetDeferred(const bool isEnabled) {
+    if (isEnabled == isDeferred) {
+        return;
+    }
+
+    if (isDrawingLayer) {
+        DrvGpuEndCache(drawingLayer);
+    }
+
+    if (isDeferred) {
+        flushCommands();
+    } else {
+        resetCommands();
+    }
+
+    isDeferred  = isEnabled;
+    isRecording = isEnabled;
+}
+
+void DrvGpuGetColor(const u8 colorIndex, u8* redValue, u8* greenValue, u8* blueValue) {
+    *redValue   = colorPalette[colorIndex * 3];
+    *greenValue = colorPalette[colorIndex * 3 + 1];
+    *blueValue  = colorPalette[colorIndex * 3 + 2];
+}
+
+// The effects are kept until replaced or cleared (with NULL). The display only walks the table when at
+// least one row has an effect, so an unused table costs nothing.
+
+void DrvGpuSetLineEffects(const LineEffect* newEffects, const i32 firstRow, const i32 numberOfRows) {
+    i32 startRow = firstRow < 0 ? 0 : firstRow;
+    i32 endRow   = firstRow + numberOfRows > ScreenHeight ? ScreenHeight : firstRow + numberOfRows;
+
+    for (i32 rowIndex = startRow; rowIndex < endRow; rowIndex++) {
+        if (newEffects) {
+            lineEffects[rowIndex] = newEffects[rowIndex - firstRow];
+        } else {
+            memset(&lineEffects[rowIndex], 0, sizeof(LineEffect));
+        }
+    }
+
+    hasLineEffects = false;
+
+    for (u32 rowIndex = 0; rowIndex < ScreenHeight && !hasLineEffects; rowIndex++) {
+        hasLineEffects = lineEffects[rowIndex].ScrollX != 0 || lineEffects[rowIndex].RowOffset != 0 || lineEffects[rowIndex].ColorOffset != 0;
+    }
+}
+
+u8 DrvGpuGetNearestColorIndex(const u8 redValue, const u8 greenValue, const u8 blueValue) {
+    u32 lutIndex = GetColorLutIndex(redValue, greenValue, blueValue);
+
+    if (!(colorLutEntries[lutIndex >> 5] & (1u << (lutIndex & 31)))) {
+        startTimer();
+
+        colorLut[lutIndex] = BuildColorLutEntry(colorPalette, lutIndex);
+        colorLutEntries[lutIndex >> 5] |= 1u << (lutIndex & 31);
+
+        stopTimer();
+    }
+
+    return colorLut[lutIndex];
+}
+
+void DrvGpuDraw(const Image* image, const Point2D* position, const Rectangle2D* clipRect) {
+    isFrameDrawn |= !isDrawingLayer;
+
+    if (isRecording) {
+        drawCommand* command = recordCommand(drawCommandImage, position->Y, position->Y + clipRect->Height);
+
+        if (command) {
+            command->image.image      = *image;
+            command->image.position   = *position;
+            command->image.sourceRect = *clipRect;
+        }
+
+        return;
+    }
+
+    Rectangle2D offsetTargetRect = {
+        .X      = position->X,
+        .Y      = position->Y,
+        .Width  = clipRect->Width,
+        .Height = clipRect->Height,
     };
 
-    static float redStep, greenStep, blueStep;
+    Rectangle2D offsetClipRect = *clipRect;
+
+    if ((offsetTargetRect.X > ScreenWidth) || (offsetTargetRect.Y > clipBottom) ||
+        (offsetTargetRect.X + offsetTargetRect.Width < 0) || (offsetTargetRect.Y + offsetTargetRect.Height < clipTop)) {
+        return;
+    }
+
+    startTimer();
+
+    if (offsetTargetRect.X < 0) {
+        offsetClipRect.X -= offsetTargetRect.X;
+        offsetClipRect.Width += offsetTargetRect.X;
+
+        offsetTargetRect.Width += offsetTargetRect.X;
+        offsetTargetRect.X = 0;
+    }
+
+    if (offsetTargetRect.X + offsetTargetRect.Width > ScreenWidth) {
+        offsetTargetRect.Width -= (offsetTargetRect.X + offsetTargetRect.Width) - ScreenWidth;
+        offsetClipRect.Width = offsetTargetRect.Width;
+    }
+
+    if (offsetTargetRect.Y < clipTop) {
+        offsetClipRect.Y += clipTop - offsetTargetRect.Y;
+        offsetClipRect.Height -= clipTop - offsetTargetRect.Y;
+
+        offsetTargetRect.Height -= clipTop - offsetTargetRect.Y;
+        offsetTargetRect.Y = clipTop;
+    }
+
+    if (offsetTargetRect.Y + offsetTargetRect.Height > clipBottom) {
+        offsetTargetRect.Height -= (offsetTargetRect.Y + offsetTargetRect.Height) - clipBottom;
+        offsetClipRect.Height = offsetTargetRect.Height;
+    }
+
+    if (offsetTargetRect.Width > 0 && offsetTargetRect.Height > 0) {
+        const u8* sourceRow = &image->Data[(offsetClipRect.Y * image->Width) + offsetClipRect.X];
+        u8*       targetRow = &framebuffer[(offsetTargetRect.Y * ScreenWidth) + offsetTargetRect.X];
+
+        copyRows(targetRow, sourceRow, image->Width, offsetTargetRect.Width, offsetTargetRect.Height, transparentColor);
+    }
+
+    stopTimer();
+}
+
+// Writes each source pixel xScale times, with the scale fixed per loop so the stores are unrolled.
+
+static void expandRow(u8* targetRow, const u8* sourceRow, const i32 numberOfPixels, const i32 xScale, const u16 keyColor) {
+    switch (xScale) {
+        case 2: {
+            for (i32 pixelX = 0; pixelX < numberOfPixels; pixelX++, targetRow += 2) {
+                if (sourceRow[pixelX] != keyColor) {
+                    targetRow[0] = targetRow[1] = sourceRow[pixelX];
+                }
+            }
 
-    uint colorIndex = 0;
+            break;
+        }
 
-    for (uint rowIndex = 0; rowIndex < 16; rowIndex++) {
-        redStep   = (float) (midValues[rowIndex * 3] - minValues[rowIndex * 3]) / 7.0f;
-        greenStep = (float) (midValues[rowIndex * 3 + 1] - minValues[rowIndex * 3 + 1]) / 7.0f;
-        blueStep  = (float) (midValues[rowIndex * 3 + 2] - minValues[rowIndex * 3 + 2]) / 7.0f;
+        case 3: {
+            for (i32 pixelX = 0; pixelX < numberOfPixels; pixelX++, targetRow += 3) {
+                if (sourceRow[pixelX] != keyColor) {
+                    targetRow[0] = targetRow[1] = targetRow[2] = sourceRow[pixelX];
+                }
+            }
 
-        for (uint columnIndex = 0; columnIndex < 8; columnIndex++) {
-            colorPalette[colorIndex * 3]     = minValues[rowIndex * 3] + floor((float) columnIndex * redStep);
-            colorPalette[colorIndex * 3 + 1] = minValues[rowIndex * 3 + 1] + floor((float) columnIndex * greenStep);
-            colorPalette[colorIndex * 3 + 2] = minValues[rowIndex * 3 + 2] + floor((float) columnIndex * blueStep);
-            colorIndex++;
+            break;
         }
 
-        redStep   = (float) (maxValues[rowIndex * 3] - midValues[rowIndex * 3]) / 8.0f;
-        greenStep = (float) (maxValues[rowIndex * 3 + 1] - midValues[rowIndex * 3 + 1]) / 8.0f;
-        blueStep  = (float) (maxValues[rowIndex * 3 + 2] - midValues[rowIndex * 3 + 2]) / 8.0f;
+        default: {
+            for (i32 pixelX = 0; pixelX < numberOfPixels; pixelX++, targetRow += 4) {
+                if (sourceRow[pixelX] != keyColor) {
+                    targetRow[0] = targetRow[1] = targetRow[2] = targetRow[3] = sourceRow[pixelX];
+                }
+            }
 
-        for (uint columnIndex = 1; columnIndex < 9; columnIndex++) {
-            colorPalette[colorIndex * 3]     = midValues[rowIndex * 3] + floor((float) columnIndex * redStep);
-            colorPalette[colorIndex * 3 + 1] = midValues[rowIndex * 3 + 1] + floor((float) columnIndex * greenStep);
-            colorPalette[colorIndex * 3 + 2] = midValues[rowIndex * 3 + 2] + floor((float) columnIndex * blueStep);
-            colorIndex++;
+            break;
         }
     }
 }
 
-// Driver ---------------------------------------------------------------------
+void DrvGpuDrawScaled(const Image* image, const Rectangle2D* sourceRect, const Rectangle2D* targetRect) {
+    isFrameDrawn |= !isDrawingLayer;
 
-#define startTimer() u64 startTime = DrvCpuGetTick()
-#define stopTimer()  busyTime += DrvCpuGetTick() - startTime
+    if (isRecording) {
+        drawCommand* command = recordCommand(drawCommandScaled, targetRect->Y, targetRect->Y + targetRect->Height);
 
-bool DrvGpuInitialize(void) {
-    buildColorPalette();
-    DrvDisplaySetColorPallete(colorPalette);
-    memset(&framebuffer, 0, sizeof(framebuffer));
-    busyTime = 0;
-    return true;
-}
+        if (command) {
+            command->scaled.image      = *image;
+            command->scaled.sourceRect = *sourceRect;
+            command->scaled.targetRect = *targetRect;
+        }
 
-void DrvGpuFinalize(void) {
-    // Empty
-}
+        return;
+    }
+
+    if (targetRect->Width <= 0 || targetRect->Height <= 0 || sourceRect->Width <= 0 || sourceRect->Height <= 0) {
+        return;
+    }
+
+    i32 firstColumn = targetRect->X < 0 ? -targetRect->X : 0;
+    i32 lastColumn  = targetRect->X + targetRect->Width > ScreenWidth ? ScreenWidth - targetRect->X : targetRect->Width;
+    i32 firstRow    = targetRect->Y < clipTop ? clipTop - targetRect->Y : 0;
+    i32 lastRow     = targetRect->Y + targetRect->Height > clipBottom ? clipBottom - targetRect->Y : targetRect->Height;
+
+    if (firstColumn >= lastColumn || firstRow >= lastRow) {
+        return;
+    }
 
-void DrvGpuClear(const u8 colorIndex) {
     startTimer();
 
-    for (uint pixelIndex = 0; pixelIndex < ScreenPixels; pixelIndex++) {
-        framebuffer[pixelIndex] = colorIndex;
+    static u16 sourceColumns[ScreenWidth];
+
+    // Source coordinates are stepped with an exact integer DDA (whole step plus an error term) from the
+    // first visible pixel, so clipped draws land on the same source pixels as unclipped ones.
+
+    i32 numberOfColumns = lastColumn - firstColumn;
+    i32 xScale          = targetRect->Width / sourceRect->Width;
+    i32 sourceX         = sourceRect->X + (firstColumn * sourceRect->Width) / targetRect->Width;
+    i32 xError          = (firstColumn * sourceRect->Width) % targetRect->Width;
+    i32 xWholeStep      = sourceRect->Width / targetRect->Width;
+    i32 xErrorStep      = sourceRect->Width % targetRect->Width;
+
+    for (i32 columnIndex = 0; columnIndex < numberOfColumns; columnIndex++) {
+        sourceColumns[columnIndex] = sourceX;
+
+        sourceX += xWholeStep;
+        xError += xErrorStep;
+
+        if (xError >= targetRect->Width) {
+            xError -= targetRect->Width;
+            sourceX++;
+        }
     }
 
-    stopTimer();
-}
+    i32 sourceY    = sourceRect->Y + (firstRow * sourceRect->Height) / targetRect->Height;
+    i32 yError     = (firstRow * sourceRect->Height) % targetRect->Height;
+    i32 yWholeStep = sourceRect->Height / targetRect->Height;
+    i32 yErrorStep = sourceRect->Height % targetRect->Height;
 
-u64 DrvGpuSync(void) {
-    DrvDisplaySync(framebuffer);
-    lastBusyTime = busyTime;
-    busyTime     = 0;
-    return lastBusyTime;
-}
+    // Whole 2x, 3x and 4x horizontal scales with a cell-aligned clip can expand each source pixel directly.
 
-u64 DrvGpuGetTime(void) {
-    return lastBusyTime;
-}
+    bool isIntegerScale = xScale >= 2 && xScale <= 4 && targetRect->Width == sourceRect->Width * xScale &&
+                          firstColumn % xScale == 0 && numberOfColumns % xScale == 0;
 
-void DrvGpuSetTransparentColor(const u16 colorIndex) {
-    transparentColor = colorIndex;
-}
+    bool isKeyed       = transparentColor != ColorNone && backgroundColor == ColorNone;
+    bool hasOverrides  = foregroundColor != ColorNone || (transparentColor != ColorNone && backgroundColor != ColorNone) || hasDrawRemap;
+    i32  lastSourceRow = -1;
 
-void DrvGpuSetBackgroundColor(const u16 colorIndex) {
-    backgroundColor = colorIndex;
-}
+    u8* targetRow = &framebuffer[((targetRect->Y + firstRow) * ScreenWidth) + targetRect->X + firstColumn];
 
-void DrvGpuSetForegroundColor(const u16 colorIndex) {
-    foregroundColor = colorIndex;
-}
+    for (i32 rowIndex = firstRow; rowIndex < lastRow; rowIndex++) {
+        i32 rowSourceY = sourceY;
 
-u8 DrvGpuGetNearestColorIndex(const u8 redValue, const u8 greenValue, const u8 blueValue) {
-    startTimer();
+        sourceY += yWholeStep;
+        yError += yErrorStep;
 
-    u8  nearestIndex    = 0;
-    int nearestDistance = INT32_MAX;
+        if (yError >= targetRect->Height) {
+            yError -= targetRect->Height;
+            sourceY++;
+        }
+
+        // Every pixel of an unkeyed row is written, so a repeated source row is a copy of the row above.
+
+        if (!isKeyed && rowSourceY == lastSourceRow) {
+            memcpy(targetRow, targetRow - ScreenWidth, numberOfColumns);
+            targetRow += ScreenWidth;
+            continue;
+        }
 
-    static int colorDistance;
-    static int redDiff, greenDiff, blueDiff;
+        const u8* sourceRow = &image->Data[rowSourceY * image->Width];
+        lastSourceRow       = rowSourceY;
 
-    for (uint colorIndex = 0; colorIndex < ScreenColors; ++colorIndex) {
-        redDiff   = colorPalette[colorIndex * 3] - redValue;
-        greenDiff = colorPalette[colorIndex * 3 + 1] - greenValue;
-        blueDiff  = colorPalette[colorIndex * 3 + 2] - blueValue;
+        if (hasOverrides) {
+            for (i32 columnIndex = 0; columnIndex < numberOfColumns; columnIndex++) {
+                u8 pixelColor = sourceRow[sourceColumns[columnIndex]];
 
-        colorDistance = (2 * redDiff * redDiff) + (4 * greenDiff * greenDiff) + (3 * blueDiff * blueDiff);
+                if (pixelColor == transparentColor) {
+                    if (backgroundColor == ColorNone) {
+                        continue;
+                    }
 
-        if (colorDistance < nearestDistance) {
-            nearestDistance = colorDistance;
-            nearestIndex    = colorIndex;
+                    pixelColor = backgroundColor;
+                } else if (foregroundColor != ColorNone) {
+                    pixelColor = foregroundColor;
+                }
+
+                targetRow[columnIndex] = drawRemap[pixelColor];
+            }
+        } else if (isIntegerScale) {
+            expandRow(targetRow, &sourceRow[sourceColumns[0]], numberOfColumns / xScale, xScale, isKeyed ? transparentColor : ColorNone);
+        } else if (isKeyed) {
+            for (i32 columnIndex = 0; columnIndex < numberOfColumns; columnIndex++) {
+                u8 pixelColor = sourceRow[sourceColumns[columnIndex]];
+
+                if (pixelColor != transparentColor) {
+                    targetRow[columnIndex] = pixelColor;
+                }
+            }
+        } else {
+            for (i32 columnIndex = 0; columnIndex < numberOfColumns; columnIndex++) {
+                targetRow[columnIndex] = sourceRow[sourceColumns[columnIndex]];
+            }
         }
+
+        targetRow += ScreenWidth;
     }
 
     stopTimer();
-    return nearestIndex;
 }
 
-void DrvGpuDraw(const Image* image, const Point2D* position, const Rectangle2D* clipRect) {
-    Rectangle2D offsetTargetRect = {
-        .X      = position->X,
-        .Y      = position->Y,
-        .Width  = clipRect->Width,
-        .Height = clipRect->Height,
-    };
+static inline i64 floorDivide(const i64 numerator, const i64 denominator) {
+    i64 quotient = numerator / denominator;
+    return ((numerator % denominator) != 0 && ((numerator < 0) != (denominator < 0))) ? quotient - 1 : quotient;
+}
 
-    Rectangle2D offsetClipRect = *clipRect;
+// Narrows the column span to the columns where (start + column * step) stays inside [0, limit).
+
+static inline void clipAffineSpan(const i64 start, const i64 step, const i64 limit, i32* firstColumn, i32* lastColumn) {
+    i64 spanFirst, spanLast;
+
+    if (step == 0) {
+        if (start < 0 || start >= limit) {
+            *lastColumn = *firstColumn - 1;
+        }
 
-    if ((offsetTargetRect.X > ScreenWidth) || (offsetTargetRect.Y > ScreenHeight) ||
-        (offsetTargetRect.X + offsetTargetRect.Width < 0) || (offsetTargetRect.Y + offsetTargetRect.Height < 0)) {
         return;
     }
 
-    startTimer();
+    if (step > 0) {
+        spanFirst = -floorDivide(start, step);
+        spanLast  = -floorDivide(start - limit, step) - 1;
+    } else {
+        spanFirst = floorDivide(limit - start, step) + 1;
+        spanLast  = floorDivide(-start, step);
+    }
 
-    if (offsetTargetRect.X < 0) {
-        offsetClipRect.X -= offsetTargetRect.X;
-        offsetClipRect.Width += offsetTargetRect.X;
+    if (spanFirst > *firstColumn) {
+        *firstColumn = spanFirst > ScreenWidth ? ScreenWidth : (i32) spanFirst;
+    }
 
-        offsetTargetRect.Width += offsetTargetRect.X;
-        offsetTargetRect.X = 0;
+    if (spanLast < *lastColumn) {
+        *lastColumn = spanLast < -1 ? -1 : (i32) spanLast;
     }
+}
 
-    if (offsetTargetRect.X + offsetTargetRect.Width > ScreenWidth) {
-        offsetTargetRect.Width -= (offsetTargetRect.X + offsetTargetRect.Width) - ScreenWidth;
-        offsetClipRect.Width = offsetTargetRect.Width;
+void DrvGpuDrawAffine(const Image* image, const Rectangle2D* sourceRect, const Point2D* position, const FixedPoint2D* pivot, const FixedMatrix2D* matrix) {
+    isFrameDrawn |= !isDrawingLayer;
+
+    if (sourceRect->Width <= 0 || sourceRect->Height <= 0) {
+        return;
     }
 
-    if (offsetTargetRect.Y < 0) {
-        offsetClipRect.Y -= offsetTargetRect.Y;
-        offsetClipRect.Height += offsetTargetRect.Y;
+    i64 determinant = ((i64) matrix->A * matrix->D - (i64) matrix->B * matrix->C) >> 16;
 
-        offsetTargetRect.Height += offsetTargetRect.Y;
-        offsetTargetRect.Y = 0;
+    if (determinant == 0) {
+        return;
     }
 
-    if (offsetTargetRect.Y + offsetTargetRect.Height > ScreenHeight) {
-        offsetTargetRect.Height -= (offsetTargetRect.Y + offsetTargetRect.Height) - ScreenHeight;
-        offsetClipRect.Height = offsetTargetRect.Height;
+    // The inverse matrix maps screen offsets back into the source rect. Transforms that shrink the image
+    // so much that the inverse no longer fits in an f16 step cover less than a pixel and are skipped.
+
+    i64 inverseA = ((i64) matrix->D * F16One) / determinant;
+    i64 inverseB = (-(i64) matrix->B * F16One) / determinant;
+    i64 inverseC = (-(i64) matrix->C * F16One) / determinant;
+    i64 inverseD = ((i64) matrix->A * F16One) / determinant;
+
+    if (llabs(inverseA) > F16Maximum / 2 || llabs(inverseB) > F16Maximum / 2 ||
+        llabs(inverseC) > F16Maximum / 2 || llabs(inverseD) > F16Maximum / 2) {
+        return;
+    }
+
+    // The screen rows come from the bounding box of the transformed source corners.
+
+    i64 sourceWidth  = F16(sourceRect->Width);
+    i64 sourceHeight = F16(sourceRect->Height);
+    i64 minimumY     = INT64_MAX;
+    i64 maximumY     = INT64_MIN;
+
+    for (u32 cornerIndex = 0; cornerIndex < 4; cornerIndex++) {
+        i64 cornerX = ((cornerIndex & 1) ? sourceWidth : 0) - pivot->X;
+        i64 cornerY = ((cornerIndex & 2) ? sourceHeight : 0) - pivot->Y;
+        i64 screenY = (matrix->C * cornerX + matrix->D * cornerY) >> 16;
+
+        minimumY = screenY < minimumY ? screenY : minimumY;
+        maximumY = screenY > maximumY ? screenY : maximumY;
+    }
+
+    // Pixels are sampled at their centers, so the row holding the bottom corner is the last one they can cover.
+
+    i32 firstRow = position->Y + (i32) (minimumY >> 16);
+    i32 endRow   = position->Y + (i32) (maximumY >> 16) + 1;
+
+    if (isRecording) {
+        drawCommand* command = recordCommand(drawCommandAffine, firstRow, endRow);
+
+        if (command) {
+            command->affine.image      = *image;
+            command->affine.sourceRect = *sourceRect;
+            command->affine.position   = *position;
+            command->affine.pivot      = *pivot;
+            command->affine.matrix     = *matrix;
+        }
+
+        return;
+    }
+
+    firstRow = firstRow < clipTop ? clipTop : firstRow;
+    endRow   = endRow > clipBottom ? clipBottom : endRow;
+
+    if (firstRow >= endRow) {
+        return;
     }
 
-    static u32 sourcePixelIndex, targetPixelIndex;
-    static u8  pixelColor;
+    startTimer();
+
+    const u8* sourceOrigin = &image->Data[(sourceRect->Y * image->Width) + sourceRect->X];
+
+    bool hasOverrides = foregroundColor != ColorNone || (transparentColor != ColorNone && backgroundColor != ColorNone) || hasDrawRemap;
+    i64  columnOffset = (F16One / 2) - ((i64) position->X * F16One);
+
+    for (i32 rowIndex = firstRow; rowIndex < endRow; rowIndex++) {
+        // Source coordinates of the center of column zero, stepped by the inverse matrix's first column.
+
+        i64 rowOffset = F16(rowIndex) + (F16One / 2) - ((i64) position->Y * F16One);
+        i64 rowU      = pivot->X + ((inverseA * columnOffset + inverseB * rowOffset) >> 16);
+        i64 rowV      = pivot->Y + ((inverseC * columnOffset + inverseD * rowOffset) >> 16);
+
+        i32 firstColumn = 0;
+        i32 lastColumn  = ScreenWidth - 1;
+
+        clipAffineSpan(rowU, inverseA, sourceWidth, &firstColumn, &lastColumn);
+        clipAffineSpan(rowV, inverseC, sourceHeight, &firstColumn, &lastColumn);
+
+        if (firstColumn > lastColumn) {
+            continue;
+        }
+
+        f16 sourceU = (f16) (rowU + (firstColumn * inverseA));
+        f16 sourceV = (f16) (rowV + (firstColumn * inverseC));
+        f16 stepU   = (f16) inverseA;
+        f16 stepV   = (f16) inverseC;
+
+        u8* targetPixel = &framebuffer[(rowIndex * ScreenWidth) + firstColumn];
+
+        if (hasOverrides) {
+            for (i32 columnIndex = firstColumn; columnIndex <= lastColumn; columnIndex++, targetPixel++) {
+                u8 pixelColor = sourceOrigin[((sourceV >> 16) * image->Width) + (sourceU >> 16)];
+
+                sourceU += stepU;
+                sourceV += stepV;
 
-    for (u16 pixelY = 0; pixelY < offsetTargetRect.Height; pixelY++) {
-        for (u16 pixelX = 0; pixelX < offsetTargetRect.Width; pixelX++) {
-            sourcePixelIndex = ((offsetClipRect.Y + pixelY) * image->Width) + (offsetClipRect.X + pixelX);
-            pixelColor       = image->Data[sourcePixelIndex];
+                if (pixelColor == transparentColor) {
+                    if (backgroundColor == ColorNone) {
+                        continue;
+                    }
 
-            if (pixelColor == transparentColor) {
-                if (backgroundColor == ColorNone) {
-                    continue;
+                    pixelColor = backgroundColor;
+                } else if (foregroundColor != ColorNone) {
+                    pixelColor = foregroundColor;
                 }
 
-                pixelColor = backgroundColor;
-            } else if (foregroundColor != ColorNone) {
-                pixelColor = foregroundColor;
+                *targetPixel = drawRemap[pixelColor];
             }
+        } else {
+            for (i32 columnIndex = firstColumn; columnIndex <= lastColumn; columnIndex++, targetPixel++) {
+                u8 pixelColor = sourceOrigin[((sourceV >> 16) * image->Width) + (sourceU >> 16)];
 
-            targetPixelIndex              = ((offsetTargetRect.Y + pixelY) * ScreenWidth) + (offsetTargetRect.X + pixelX);
-            framebuffer[targetPixelIndex] = pixelColor;
+                sourceU += stepU;
+                sourceV += stepV;
+
+                if (pixelColor != transparentColor) {
+                    *targetPixel = pixelColor;
+                }
+            }
         }
     }
 
     stopTimer();
 }
 
-void DrvGpuDrawScaled(const Image* image, const Rectangle2D* sourceRect, const Rectangle2D* targetRect) {
-    Rectangle2D offsetSourceRect = *sourceRect;
-    Rectangle2D offsetTargetRect = *targetRect;
+void DrvGpuDrawTileMapLines(const TileMap* tileMap, const ScanlineTransform* lineTransforms, const i32 firstRow, const i32 numberOfRows) {
+    isFrameDrawn |= !isDrawingLayer;
 
-    if ((offsetTargetRect.X > ScreenWidth) || (offsetTargetRect.Y > ScreenHeight) ||
-        (offsetTargetRect.X + offsetTargetRect.Width < 0) || (offsetTargetRect.Y + offsetTargetRect.Height < 0)) {
+    const Image* tileset  = tileMap->Tileset;
+    u32          tileSize = tileMap->TileSize;
+
+    if (!tileset || !tileMap->Tiles || !tileSize || (tileSize & (tileSize - 1)) || tileset->Width < tileSize || tileset->Height < tileSize) {
         return;
     }
 
-    startTimer();
+    u32 tileBits    = __builtin_ctz(tileSize);
+    u32 tileMask    = tileSize - 1;
+    i64 mapWidth    = (i64) tileMap->Width << tileBits;
+    i64 mapHeight   = (i64) tileMap->Height << tileBits;
+    i32 startRow    = firstRow < clipTop ? clipTop : firstRow;
+    i32 endRow      = firstRow + numberOfRows > clipBottom ? clipBottom : firstRow + numberOfRows;
+    u32 tilesPerRow = tileset->Width >> tileBits;
 
-    static i16 offsetDifference;
+    if (!mapWidth || !mapHeight || mapWidth > 16383 || mapHeight > 16383 || startRow >= endRow) {
+        return;
+    }
 
-    f16 sourcePixelWidth  = F16Div(F16(sourceRect->Width), F16(targetRect->Width));
-    f16 sourcePixelHeight = F16Div(F16(sourceRect->Height), F16(targetRect->Height));
+    // Only the visible line transforms are kept, since the caller's array may be reused afterwards. Draws
+    // with more rows than the whole line buffer holds are drawn right away, after what was recorded before.
 
-    if (offsetTargetRect.X < 0) {
-        offsetDifference = F16ToInt(F16Mult(F16(offsetTargetRect.X), sourcePixelWidth));
-        offsetSourceRect.X -= offsetDifference;
-        offsetSourceRect.Width += offsetDifference;
+    i32 visibleRows = endRow - startRow;
 
-        offsetTargetRect.Width += offsetTargetRect.X;
-        offsetTargetRect.X = 0;
+    if (isRecording && numberOfDeferredLines + visibleRows > MaxDeferredLines) {
+        flushCommands();
     }
 
-    if (offsetTargetRect.X + offsetTargetRect.Width > ScreenWidth) {
-        offsetTargetRect.Width -= (offsetTargetRect.X + offsetTargetRect.Width) - ScreenWidth;
-        offsetSourceRect.Width = F16ToInt(F16Mult(F16(offsetTargetRect.Width), sourcePixelWidth));
-    }
+    if (isRecording && visibleRows <= MaxDeferredLines) {
+        drawCommand* command = recordCommand(drawCommandTileMap, startRow, endRow);
 
-    if (offsetTargetRect.Y < 0) {
-        offsetDifference = F16ToInt(F16Mult(F16(offsetTargetRect.Y), sourcePixelHeight));
-        offsetSourceRect.Y -= offsetDifference;
-        offsetSourceRect.Height += offsetDifference;
+        command->tileMap.tileMap      = *tileMap;
+        command->tileMap.tileset      = *tileset;
+        command->tileMap.firstLine    = numberOfDeferredLines;
+        command->tileMap.firstRow     = startRow;
+        command->tileMap.numberOfRows = visibleRows;
 
-        offsetTargetRect.Height += offsetTargetRect.Y;
-        offsetTargetRect.Y = 0;
+        memcpy(&deferredLines[numberOfDeferredLines], &lineTransforms[startRow - firstRow], visibleRows * sizeof(ScanlineTransform));
+        numberOfDeferredLines += visibleRows;
+        return;
     }
 
-    if (offsetTargetRect.Y + offsetTargetRect.Height > ScreenHeight) {
-        offsetTargetRect.Height -= (offsetTargetRect.Y + offsetTargetRect.Height) - ScreenHeight;
-        offsetSourceRect.Height = F16ToInt(F16Mult(F16(offsetTargetRect.Height), sourcePixelHeight));
+    startTimer();
+
+    // Offsets of the top-left pixel of every tile index, wrapping indexes past the end of the tileset.
+
+    static u32 tileOffsets[256];
+
+    u32 numberOfTiles = tilesPerRow * (tileset->Height >> tileBits);
+    u32 tileIndex     = 0;
+    u32 tileColumn    = 0;
+    u32 tileRowOffset = 0;
+
+    for (u32 offsetIndex = 0; offsetIndex < 256; offsetIndex++) {
+        tileOffsets[offsetIndex] = tileRowOffset + (tileColumn << tileBits);
+
+        if (++tileIndex == numberOfTiles) {
+            tileIndex     = 0;
+            tileColumn    = 0;
+            tileRowOffset = 0;
+        } else if (++tileColumn == tilesPerRow) {
+            tileColumn = 0;
+            tileRowOffset += tileSize * tileset->Width;
+        }
     }
 
-    static u16 sourcePixelX, sourcePixelY;
-    static u32 sourcePixelIndex, targetPixelIndex;
-    static u8  pixelColor;
+    const u8* tiles       = tileMap->Tiles;
+    const u8* tilesetData = tileset->Data;
+    u32       mapColumns  = tileMap->Width;
+    u32       imageWidth  = tileset->Width;
+    f16       wrapWidth   = (f16) (mapWidth << 16);
+    f16       wrapHeight  = (f16) (mapHeight << 16);
+
+    for (i32 rowIndex = startRow; rowIndex < endRow; rowIndex++) {
+        const ScanlineTransform* lineTransform = &lineTransforms[rowIndex - firstRow];
+
+        i32 firstColumn = 0;
+        i32 lastColumn  = ScreenWidth - 1;
+        f16 mapX        = lineTransform->X;
+        f16 mapY        = lineTransform->Y;
+        f16 stepX       = lineTransform->XStep;
+        f16 stepY       = lineTransform->YStep;
+
+        // Wrapped coordinates are brought into the map once per row, and with steps smaller than the map
+        // a single correction per pixel keeps them there. Unwrapped rows are clipped to the exact span of
+        // columns that land inside the map, where the correction never applies.
+
+        if (tileMap->Wrap) {
+            mapX  = mapX % wrapWidth + (mapX % wrapWidth < 0 ? wrapWidth : 0);
+            mapY  = mapY % wrapHeight + (mapY % wrapHeight < 0 ? wrapHeight : 0);
+            stepX = stepX % wrapWidth;
+            stepY = stepY % wrapHeight;
+        } else {
+            clipAffineSpan(mapX, stepX, (i64) wrapWidth, &firstColumn, &lastColumn);
+            clipAffineSpan(mapY, stepY, (i64) wrapHeight, &firstColumn, &lastColumn);
+
+            if (firstColumn > lastColumn) {
+                continue;
+            }
 
-    for (u16 pixelY = 0; pixelY < offsetTargetRect.Height; pixelY++) {
-        for (u16 pixelX = 0; pixelX < offsetTargetRect.Width; pixelX++) {
-            sourcePixelX = offsetSourceRect.X + F16ToInt(F16Mult(F16(pixelX), sourcePixelWidth));
-            sourcePixelY = offsetSourceRect.Y + F16ToInt(F16Mult(F16(pixelY), sourcePixelHeight));
+            mapX = (f16) (mapX + ((i64) firstColumn * stepX));
+            mapY = (f16) (mapY + ((i64) firstColumn * stepY));
+        }
 
-            sourcePixelIndex = (sourcePixelY * image->Width) + sourcePixelX;
-            pixelColor       = image->Data[sourcePixelIndex];
+        u8* targetPixel = &framebuffer[(rowIndex * ScreenWidth) + firstColumn];
 
-            if (pixelColor == transparentColor) {
-                if (backgroundColor == ColorNone) {
-                    continue;
-                }
+        for (i32 columnIndex = firstColumn; columnIndex <= lastColumn; columnIndex++, targetPixel++) {
+            u32 pixelX     = mapX >> 16;
+            u32 pixelY     = mapY >> 16;
+            u8  tileNumber = tiles[((pixelY >> tileBits) * mapColumns) + (pixelX >> tileBits)];
+            u8  pixelColor = tilesetData[tileOffsets[tileNumber] + ((pixelY & tileMask) * imageWidth) + (pixelX & tileMask)];
 
-                pixelColor = backgroundColor;
-            } else if (foregroundColor != ColorNone) {
-                pixelColor = foregroundColor;
+            if (pixelColor != transparentColor) {
+                *targetPixel = drawRemap[pixelColor];
             }
 
-            targetPixelIndex              = ((offsetTargetRect.Y + pixelY) * ScreenWidth) + (offsetTargetRect.X + pixelX);
-            framebuffer[targetPixelIndex] = pixelColor;
+            mapX += stepX;
+            mapY += stepY;
+            mapX += mapX >= wrapWidth ? -wrapWidth : (mapX < 0 ? wrapWidth : 0);
+            mapY += mapY >= wrapHeight ? -wrapHeight : (mapY < 0 ? wrapHeight : 0);
         }
     }
 
@@ -324,10 +1515,23 @@ void DrvGpuDrawScaled(const Image* image, const Rectangle2D* sourceRect, const R
 }
 
 void DrvGpuDrawRectangle(const Rectangle2D* rectangle, const u8 colorIndex) {
+    isFrameDrawn |= !isDrawingLayer;
+
+    if (isRecording) {
+        drawCommand* command = recordCommand(drawCommandRectangle, rectangle->Y, rectangle->Y + rectangle->Height);
+
+        if (command) {
+            command->fill.rectangle  = *rectangle;
+            command->fill.colorIndex = colorIndex;
+        }
+
+        return;
+    }
+
     Rectangle2D offsetRectangle = *rectangle;
 
-    if ((offsetRectangle.X > ScreenWidth) || (offsetRectangle.Y > ScreenHeight) ||
-        (offsetRectangle.X + offsetRectangle.Width < 0) || (offsetRectangle.Y + offsetRectangle.Height < 0)) {
+    if ((offsetRectangle.X > ScreenWidth) || (offsetRectangle.Y > clipBottom) ||
+        (offsetRectangle.X + offsetRectangle.Width < 0) || (offsetRectangle.Y + offsetRectangle.Height < clipTop)) {
         return;
     }
 
@@ -342,23 +1546,224 @@ void DrvGpuDrawRectangle(const Rectangle2D* rectangle, const u8 colorIndex) {
         offsetRectangle.Width -= (offsetRectangle.X + offsetRectangle.Width) - ScreenWidth;
     }
 
-    if (offsetRectangle.Y < 0) {
-        offsetRectangle.Height += offsetRectangle.Y;
-        offsetRectangle.Y = 0;
+    if (offsetRectangle.Y < clipTop) {
+        offsetRectangle.Height -= clipTop - offsetRectangle.Y;
+        offsetRectangle.Y = clipTop;
+    }
+
+    if (offsetRectangle.Y + offsetRectangle.Height > clipBottom) {
+        offsetRectangle.Height -= (offsetRectangle.Y + offsetRectangle.Height) - clipBottom;
+    }
+
+    if (offsetRectangle.Width > 0 && offsetRectangle.Height > 0) {
+        u8* targetRow = &framebuffer[(offsetRectangle.Y * ScreenWidth) + offsetRectangle.X];
+
+        for (i32 pixelY = 0; pixelY < offsetRectangle.Height; pixelY++) {
+            memset(targetRow, drawRemap[colorIndex], offsetRectangle.Width);
+            targetRow += ScreenWidth;
+        }
+    }
+
+    stopTimer();
+}
+
+void DrvGpuDrawPixel(const Point2D* position, const u8 colorIndex) {
+    isFrameDrawn |= !isDrawingLayer;
+
+    if (isRecording) {
+        drawCommand* command = recordCommand(drawCommandPixel, position->Y, position->Y + 1);
+
+        if (command) {
+            command->fill.rectangle  = (Rectangle2D) {.X = position->X, .Y = position->Y, .Width = 1, .Height = 1};
+            command->fill.colorIndex = colorIndex;
+        }
+
+        return;
+    }
+
+    if ((position->X < 0) || (position->Y < clipTop) || (position->X >= ScreenWidth) || (position->Y >= clipBottom)) {
+        return;
+    }
+
+    startTimer();
+    framebuffer[(position->Y * ScreenWidth) + position->X] = drawRemap[colorIndex];
+    stopTimer();
+}
+
+void DrvGpuDrawFrame(const Image* image, const Rectangle2D* frameRect, const Point2D* position, const u16 frameTransparentColor) {
+    isFrameDrawn |= !isDrawingLayer;
+
+    if (isRecording) {
+        drawCommand* command = recordCommand(drawCommandFrame, position->Y, position->Y + frameRect->Height);
+
+        if (command) {
+            command->image.image      = *image;
+            command->image.sourceRect = *frameRect;
+            command->image.position   = *position;
+            command->image.keyColor   = frameTransparentColor;
+        }
+
+        return;
+    }
+
+    i32 sourceX     = frameRect->X;
+    i32 sourceY     = frameRect->Y;
+    i32 targetX     = position->X;
+    i32 targetY     = position->Y;
+    i32 frameWidth  = frameRect->Width;
+    i32 frameHeight = frameRect->Height;
+
+    if (targetX < 0) {
+        sourceX -= targetX;
+        frameWidth += targetX;
+        targetX = 0;
     }
 
-    if (offsetRectangle.Y + offsetRectangle.Height > ScreenHeight) {
-        offsetRectangle.Height -= (offsetRectangle.Y + offsetRectangle.Height) - ScreenHeight;
+    if (targetY < clipTop) {
+        sourceY += clipTop - targetY;
+        frameHeight -= clipTop - targetY;
+        targetY = clipTop;
     }
 
-    static u32 pixelIndex;
+    if (targetX + frameWidth > ScreenWidth) {
+        frameWidth = ScreenWidth - targetX;
+    }
+
+    if (targetY + frameHeight > clipBottom) {
+        frameHeight = clipBottom - targetY;
+    }
+
+    if (frameWidth <= 0 || frameHeight <= 0) {
+        return;
+    }
+
+    startTimer();
+
+    const u8* sourceRow = &image->Data[(sourceY * image->Width) + sourceX];
+    u8*       targetRow = &framebuffer[(targetY * ScreenWidth) + targetX];
+
+    copyRows(targetRow, sourceRow, image->Width, frameWidth, frameHeight, frameTransparentColor);
+
+    stopTimer();
+}
+
+// Spans are stored per frame row as a run count followed by (skip, length) pairs, where
+// skip is counted from the end of the previous opaque run. Pixels stay in the source image.
+
+u32 DrvGpuEncodeSpans(const Image* image, const Rectangle2D* frameRect, const u16 frameTransparentColor, u16* spanWords, const u32 maxWords) {
+    startTimer();
+
+    u32 numberOfWords = 0;
+
+    for (i32 pixelY = 0; pixelY < frameRect->Height; pixelY++) {
+        const u8* sourceRow = &image->Data[((frameRect->Y + pixelY) * image->Width) + frameRect->X];
+
+        if (numberOfWords >= maxWords) {
+            stopTimer();
+            return 0;
+        }
+
+        u32 countIndex = numberOfWords++;
+        i32 runEnd     = 0;
+        i32 pixelX     = 0;
+
+        spanWords[countIndex] = 0;
+
+        while (pixelX < frameRect->Width) {
+            while (pixelX < frameRect->Width && sourceRow[pixelX] == frameTransparentColor) {
+                pixelX++;
+            }
+
+            if (pixelX >= frameRect->Width) {
+                break;
+            }
+
+            i32 runStart = pixelX;
+
+            while (pixelX < frameRect->Width && sourceRow[pixelX] != frameTransparentColor) {
+                pixelX++;
+            }
+
+            if (numberOfWords + 2 > maxWords) {
+                stopTimer();
+                return 0;
+            }
+
+            spanWords[numberOfWords++] = runStart - runEnd;
+            spanWords[numberOfWords++] = pixelX - runStart;
+            spanWords[countIndex]++;
 
-    for (u16 pixelY = 0; pixelY < offsetRectangle.Height; pixelY++) {
-        for (u16 pixelX = 0; pixelX < offsetRectangle.Width; pixelX++) {
-            pixelIndex              = ((offsetRectangle.Y + pixelY) * ScreenWidth) + (offsetRectangle.X + pixelX);
-            framebuffer[pixelIndex] = colorIndex;
+            runEnd = pixelX;
         }
     }
 
+    stopTimer();
+    return numberOfWords;
+}
+
+void DrvGpuDrawSpans(const Image* image, const Rectangle2D* frameRect, const u16* spanWords, const Point2D* position, const u16 frameTransparentColor) {
+    isFrameDrawn |= !isDrawingLayer;
+
+    if (isRecording) {
+        drawCommand* command = recordCommand(drawCommandSpans, position->Y, position->Y + frameRect->Height);
+
+        if (command) {
+            command->image.image      = *image;
+            command->image.sourceRect = *frameRect;
+            command->image.position   = *position;
+            command->image.keyColor   = frameTransparentColor;
+            command->image.spanWords  = spanWords;
+        }
+
+        return;
+    }
+
+    // Spans only know which pixels are opaque, the color overrides and remaps still need the per-pixel path.
+
+    if (backgroundColor != ColorNone || foregroundColor != ColorNone || hasDrawRemap) {
+        DrvGpuDrawFrame(image, frameRect, position, frameTransparentColor);
+        return;
+    }
+
+    i32 firstRow    = position->Y < clipTop ? clipTop - position->Y : 0;
+    i32 lastRow     = position->Y + frameRect->Height > clipBottom ? clipBottom - position->Y : frameRect->Height;
+    i32 firstColumn = position->X < 0 ? -position->X : 0;
+    i32 lastColumn  = position->X + frameRect->Width > ScreenWidth ? ScreenWidth - position->X : frameRect->Width;
+
+    if (firstRow >= lastRow || firstColumn >= lastColumn) {
+        return;
+    }
+
+    startTimer();
+
+    for (i32 rowIndex = 0; rowIndex < firstRow; rowIndex++) {
+        spanWords += 1 + (spanWords[0] * 2);
+    }
+
+    const u8* sourceRow   = &image->Data[((frameRect->Y + firstRow) * image->Width) + frameRect->X];
+    i32       targetIndex = ((position->Y + firstRow) * ScreenWidth) + position->X;
+
+    for (i32 rowIndex = firstRow; rowIndex < lastRow; rowIndex++) {
+        const u16* rowSpans = spanWords + 1;
+        i32        runEnd   = 0;
+
+        spanWords += 1 + (spanWords[0] * 2);
+
+        for (; rowSpans < spanWords && runEnd < lastColumn; rowSpans += 2) {
+            i32 runStart = runEnd + rowSpans[0];
+            runEnd       = runStart + rowSpans[1];
+
+            i32 copyStart = runStart > firstColumn ? runStart : firstColumn;
+            i32 copyEnd   = runEnd < lastColumn ? runEnd : lastColumn;
+
+            if (copyStart < copyEnd) {
+                memcpy(&framebuffer[targetIndex + copyStart], &sourceRow[copyStart], copyEnd - copyStart);
+            }
+        }
+
+        sourceRow += image->Width;
+        targetIndex += ScreenWidth;
+    }
+
     stopTimer();
 }
\ No newline at end of file
@@ -13,10 +13,221 @@ static u64 lastBusyTime = 0;
 #define startTimer() u64 startTime = GetTick()
 #define stopTimer()  busyTime += GetTick() - startTime
 
+#define MaxFixedSteps 4
+
+static bool useFixedTimestep    = false;
+static f16  stepAccumulator     = 0;
+static f16  interpolationFactor = F16One;
+
 // Sprites --------------------------------------------------------------------
 
-static u32    nextFreeSpriteIndex = 0;
-static Sprite sprites[MaxSprites];
+static u32         nextFreeSpriteIndex  = 0;
+static u32         numberOfSpriteFrames = 0;
+static u32         numberOfMaskWords    = 0;
+static u32         numberOfSpanWords    = 0;
+static Sprite      sprites[MaxSprites];
+static SpriteFrame spriteFrames[MaxSpriteFrames];
+static u32         spriteMasks[MaxSpriteMaskWords];
+static u16         spriteSpans[MaxSpriteSpanWords];
+static SpriteClip  spriteClips[MaxSpriteClips];
+
+static void releaseSpriteMask(Sprite* sprite) {
+    if (sprite->NumberOfMaskWords == 0) {
+        return;
+    }
+
+    u32 firstWord = sprite->FirstMaskWord;
+    u32 wordCount = sprite->NumberOfMaskWords;
+
+    memmove(&spriteMasks[firstWord], &spriteMasks[firstWord + wordCount], (numberOfMaskWords - firstWord - wordCount) * sizeof(u32));
+
+    numberOfMaskWords -= wordCount;
+    sprite->FirstMaskWord     = 0;
+    sprite->NumberOfMaskWords = 0;
+
+    for (u32 spriteIndex = 0; spriteIndex < MaxSprites; spriteIndex++) {
+        if (sprites[spriteIndex].NumberOfMaskWords > 0 && sprites[spriteIndex].FirstMaskWord > firstWord) {
+            sprites[spriteIndex].FirstMaskWord -= wordCount;
+        }
+    }
+}
+
+static void buildSpriteMask(Sprite* sprite) {
+    releaseSpriteMask(sprite);
+
+    if (!sprite->UseCollisionMask || sprite->NumberOfFrameRects == 0) {
+        return;
+    }
+
+    // One bit per pixel, LSB first, each frame row padded to whole 32-bit words.
+
+    u32 wordsPerRow = (sprite->FrameWidth + 31) / 32;
+    u32 wordCount   = wordsPerRow * sprite->FrameHeight * sprite->NumberOfFrameRects;
+
+    if (numberOfMaskWords + wordCount > MaxSpriteMaskWords) {
+        return;
+    }
+
+    sprite->FirstMaskWord     = numberOfMaskWords;
+    sprite->NumberOfMaskWords = wordCount;
+
+    u32* maskRow = &spriteMasks[numberOfMaskWords];
+    memset(maskRow, 0, wordCount * sizeof(u32));
+
+    for (u32 frameIndex = 0; frameIndex < sprite->NumberOfFrameRects; frameIndex++) {
+        const SpriteFrame* frame = &spriteFrames[sprite->FirstFrameRect + frameIndex];
+
+        for (u32 pixelY = 0; pixelY < sprite->FrameHeight; pixelY++) {
+            const u8* sourceRow = &sprite->Image.Data[((frame->Y + pixelY) * sprite->Image.Width) + frame->X];
+
+            for (u32 pixelX = 0; pixelX < sprite->FrameWidth; pixelX++) {
+                if (sourceRow[pixelX] != sprite->TransparentColor) {
+                    maskRow[pixelX >> 5] |= 1u << (pixelX & 31);
+                }
+            }
+
+            maskRow += wordsPerRow;
+        }
+    }
+
+    numberOfMaskWords += wordCount;
+}
+
+static void releaseSpriteSpans(Sprite* sprite) {
+    if (sprite->NumberOfSpanWords == 0) {
+        return;
+    }
+
+    u32 firstWord = sprite->FirstSpanWord;
+    u32 wordCount = sprite->NumberOfSpanWords;
+
+    memmove(&spriteSpans[firstWord], &spriteSpans[firstWord + wordCount], (numberOfSpanWords - firstWord - wordCount) * sizeof(u16));
+
+    numberOfSpanWords -= wordCount;
+    sprite->FirstSpanWord     = 0;
+    sprite->NumberOfSpanWords = 0;
+
+    for (u32 spriteIndex = 0; spriteIndex < MaxSprites; spriteIndex++) {
+        if (sprites[spriteIndex].NumberOfSpanWords > 0 && sprites[spriteIndex].FirstSpanWord > firstWord) {
+            sprites[spriteIndex].FirstSpanWord -= wordCount;
+        }
+    }
+}
+
+static void buildSpriteSpans(Sprite* sprite) {
+    releaseSpriteSpans(sprite);
+
+    // Opaque sprites gain nothing from spans, they are blitted row by row already.
+
+    if (sprite->TransparentColor >= ScreenColors || sprite->NumberOfFrameRects == 0) {
+        return;
+    }
+
+    Rectangle2D frameRect = {
+        .Width  = sprite->FrameWidth,
+        .Height = sprite->FrameHeight,
+    };
+
+    u32 wordCount = 0;
+
+    for (u32 frameIndex = 0; frameIndex < sprite->NumberOfFrameRects; frameIndex++) {
+        SpriteFrame* frame = &spriteFrames[sprite->FirstFrameRect + frameIndex];
+
+        frameRect.X = frame->X;
+        frameRect.Y = frame->Y;
+
+        u32 frameWords = EncodeImageSpans(&sprite->Image, &frameRect, sprite->TransparentColor, &spriteSpans[numberOfSpanWords + wordCount], MaxSpriteSpanWords - numberOfSpanWords - wordCount);
+
+        // Out of span space: the whole sprite keeps using the per-pixel blitter.
+
+        if (frameWords == 0) {
+            return;
+        }
+
+        frame->SpanOffset = wordCount;
+        wordCount += frameWords;
+    }
+
+    sprite->FirstSpanWord     = numberOfSpanWords;
+    sprite->NumberOfSpanWords = wordCount;
+    numberOfSpanWords += wordCount;
+}
+
+static void releaseSpriteFrames(Sprite* sprite) {
+    if (sprite->NumberOfFrameRects == 0) {
+        return;
+    }
+
+    u32 firstFrame = sprite->FirstFrameRect;
+    u32 frameCount = sprite->NumberOfFrameRects;
+
+    memmove(&spriteFrames[firstFrame], &spriteFrames[firstFrame + frameCount], (numberOfSpriteFrames - firstFrame - frameCount) * sizeof(SpriteFrame));
+
+    numberOfSpriteFrames -= frameCount;
+    sprite->FirstFrameRect     = 0;
+    sprite->NumberOfFrameRects = 0;
+
+    for (u32 spriteIndex = 0; spriteIndex < MaxSprites; spriteIndex++) {
+        if (sprites[spriteIndex].NumberOfFrameRects > 0 && sprites[spriteIndex].FirstFrameRect > firstFrame) {
+            sprites[spriteIndex].FirstFrameRect -= frameCount;
+        }
+    }
+}
+
+static void buildSpriteFrames(Sprite* sprite) {
+    releaseSpriteMask(sprite);
+    releaseSpriteSpans(sprite);
+    releaseSpriteFrames(sprite);
+
+    if (sprite->FrameWidth == 0 || sprite->FrameHeight == 0) {
+        return;
+    }
+
+    u32 framesPerRow = sprite->Image.Width / sprite->FrameWidth;
+    u32 frameCount   = framesPerRow * (sprite->Image.Height / sprite->FrameHeight);
+
+    // Animated sprites only need the frames their animation and clips reach; static sheets get the whole grid.
+
+    if (sprite->NumberOfFrames > 0) {
+        u32 usedFrames = sprite->NumberOfFrames;
+
+        for (u32 clipIndex = 0; clipIndex < MaxSpriteClips; clipIndex++) {
+            const SpriteClip* clip = &spriteClips[clipIndex];
+
+            if (!clip->IsFree && clip->SpriteIndex == sprite->Index && clip->FirstFrame + clip->NumberOfFrames > usedFrames) {
+                usedFrames = clip->FirstFrame + clip->NumberOfFrames;
+            }
+        }
+
+        if (usedFrames < frameCount) {
+            frameCount = usedFrames;
+        }
+    }
+
+    if (frameCount == 0 || numberOfSpriteFrames + frameCount > MaxSpriteFrames) {
+        return;
+    }
+
+    sprite->FirstFrameRect     = numberOfSpriteFrames;
+    sprite->NumberOfFrameRects = frameCount;
+
+    for (u32 frameIndex = 0; frameIndex < frameCount; frameIndex++) {
+        spriteFrames[numberOfSpriteFrames].X = (frameIndex % framesPerRow) * sprite->FrameWidth;
+        spriteFrames[numberOfSpriteFrames].Y = (frameIndex / framesPerRow) * sprite->FrameHeight;
+        numberOfSpriteFrames++;
+    }
+
+    buildSpriteMask(sprite);
+    buildSpriteSpans(sprite);
+}
+
+static void releaseSpriteClips(const Sprite* sprite) {
+    for (u32 clipIndex = 0; clipIndex < MaxSpriteClips; clipIndex++) {
+        if (spriteClips[clipIndex].SpriteIndex == sprite->Index) {
+            spriteClips[clipIndex].IsFree = true;
+        }
+    }
+}
 
 Sprite* GetSprite(const Image* image) {
     if (nextFreeSpriteIndex >= MaxSprites) {
@@ -33,6 +244,14 @@ Sprite* GetSprite(const Image* image) {
     sprites[nextFreeSpriteIndex].FrameSpeed       = 0;
     sprites[nextFreeSpriteIndex].NumberOfFrames   = 0;
 
+    sprites[nextFreeSpriteIndex].FirstFrameRect     = 0;
+    sprites[nextFreeSpriteIndex].NumberOfFrameRects = 0;
+    sprites[nextFreeSpriteIndex].UseCollisionMask   = false;
+    sprites[nextFreeSpriteIndex].FirstMaskWord      = 0;
+    sprites[nextFreeSpriteIndex].NumberOfMaskWords  = 0;
+    sprites[nextFreeSpriteIndex].FirstSpanWord      = 0;
+    sprites[nextFreeSpriteIndex].NumberOfSpanWords  = 0;
+
     Sprite* sprite = &sprites[nextFreeSpriteIndex];
 
     if (nextFreeSpriteIndex < MaxSprites) {
@@ -57,6 +276,14 @@ Sprite* GetSpriteByIndex(const u32 spriteIndex) {
 }
 
 void ReleaseSprite(Sprite* sprite) {
+    if (!sprite) {
+        return;
+    }
+
+    releaseSpriteMask(sprite);
+    releaseSpriteSpans(sprite);
+    releaseSpriteFrames(sprite);
+    releaseSpriteClips(sprite);
     sprite->IsFree = true;
 
     if (sprite->Index < nextFreeSpriteIndex) {
@@ -64,221 +291,1769 @@ void ReleaseSprite(Sprite* sprite) {
     }
 }
 
-// Entities -------------------------------------------------------------------
-
-static u32    numberOfEntities[MaxLayers];
-static Entity entities[MaxLayers][MaxLayerEntities];
+void SetSpriteProps(Sprite* sprite, const u16 transparentColor, const u16 frameWidth, const u16 frameHeight) {
+    startTimer();
 
-static void drawEntity(Entity* entity) {
-    u8 framesPerRow = entity->Sprite->Image.Width / entity->Sprite->FrameWidth;
-    u8 frameRow     = F16ToInt(entity->FrameIndex) / framesPerRow;
-    u8 frameColumn  = F16ToInt(entity->FrameIndex) % framesPerRow;
+    sprite->TransparentColor = transparentColor;
+    sprite->FrameWidth       = frameWidth;
+    sprite->FrameHeight      = frameHeight;
 
-    Rectangle2D frameRect = {
-        .X      = frameColumn * entity->Sprite->FrameWidth,
-        .Y      = frameRow * entity->Sprite->FrameHeight,
-        .Width  = entity->Sprite->FrameWidth,
-        .Height = entity->Sprite->FrameHeight,
-    };
+    buildSpriteFrames(sprite);
 
-    SetTransparentColor(entity->Sprite->TransparentColor);
-    DrawImage(&entity->Sprite->Image, F16ToInt(entity->Position.X), F16ToInt(entity->Position.Y), &frameRect);
+    stopTimer();
 }
 
-u32 GetNumberOfEntities(const u8 layerIndex) {
-    return layerIndex < MaxLayers ? numberOfEntities[layerIndex] : 0;
-}
+void SetSpriteFrames(Sprite* sprite, const u8 numberOfFrames, const f16 frameSpeed) {
+    startTimer();
 
-Entity* GetEntity(const u8 layerIndex, const u32 typeID, const Sprite* sprite, const f16 xPosition, const f16 yPosition) {
-    if (layerIndex >= MaxLayers || numberOfEntities[layerIndex] >= MaxLayerEntities) {
-        return 0;
-    }
+    sprite->NumberOfFrames = numberOfFrames;
+    sprite->FrameSpeed     = frameSpeed;
 
-    startTimer();
+    buildSpriteFrames(sprite);
 
-    Entity* entity = &entities[layerIndex][numberOfEntities[layerIndex]++];
+    stopTimer();
+}
 
-    entity->TypeID      = typeID;
-    entity->Position.X  = xPosition;
-    entity->Position.Y  = yPosition;
-    entity->Sprite      = (Sprite*) sprite;
-    entity->FrameIndex  = 0;
-    entity->Direction.X = 0;
-    entity->Direction.Y = 0;
-    entity->Speed.X     = 0;
-    entity->Speed.Y     = 0;
+void SetSpriteCollisionMask(Sprite* sprite, const bool useCollisionMask) {
+    startTimer();
 
-    entity->ReleaseAfterSync = false;
+    sprite->UseCollisionMask = useCollisionMask;
+    buildSpriteMask(sprite);
 
     stopTimer();
-    return entity;
 }
 
-Entity* GetEntityByIndex(const u8 layerIndex, const u32 entityIndex) {
-    if (layerIndex >= MaxLayers || entityIndex >= numberOfEntities[layerIndex]) {
+// Animation Clips ------------------------------------------------------------
+
+SpriteClip* GetSpriteClip(const Sprite* sprite, const u8 clipID) {
+    if (!sprite) {
         return NULL;
     }
 
-    return &entities[layerIndex][entityIndex];
-}
-
-void ReleaseEntity(Entity* entity) {
-    if (!entity) {
-        return;
+    for (u32 clipIndex = 0; clipIndex < MaxSpriteClips; clipIndex++) {
+        if (!spriteClips[clipIndex].IsFree && spriteClips[clipIndex].SpriteIndex == sprite->Index && spriteClips[clipIndex].ClipID == clipID) {
+            return &spriteClips[clipIndex];
+        }
     }
 
-    entity->ReleaseAfterSync = true;
+    return NULL;
 }
 
-Entity* GetCollidingEntity(const Entity* entity, const u32 otherEntityTypeID) {
-    if (!entity) {
+SpriteClip* SetSpriteClip(const Sprite* sprite, const u8 clipID, const u16 firstFrame, const u16 numberOfFrames, const f16 frameSpeed, const u8 clipMode) {
+    if (!sprite) {
         return NULL;
     }
 
-    startTimer();
+    SpriteClip* clip = GetSpriteClip(sprite, clipID);
 
-    Rectangle2D entityRect = {
-        .X      = F16ToInt(entity->Position.X),
-        .Y      = F16ToInt(entity->Position.Y),
-        .Width  = entity->Sprite->FrameWidth,
-        .Height = entity->Sprite->FrameHeight,
-    };
+    for (u32 clipIndex = 0; !clip && clipIndex < MaxSpriteClips; clipIndex++) {
+        if (spriteClips[clipIndex].IsFree) {
+            clip = &spriteClips[clipIndex];
 
-    for (u32 otherEntityIndex = 0; otherEntityIndex < numberOfEntities[entity->LayerIndex]; otherEntityIndex++) {
-        if (otherEntityIndex == entity->Index || entities[entity->LayerIndex][otherEntityIndex].TypeID != otherEntityTypeID) {
-            continue;
+            clip->IsFree       = false;
+            clip->SpriteIndex  = sprite->Index;
+            clip->ClipID       = clipID;
+            clip->FinishAction = ClipFinishNone;
+            clip->NextClipID   = 0;
         }
+    }
 
-        Rectangle2D otherEntityRect = {
-            .X      = F16ToInt(entities[entity->LayerIndex][otherEntityIndex].Position.X),
-            .Y      = F16ToInt(entities[entity->LayerIndex][otherEntityIndex].Position.Y),
-            .Width  = entities[entity->LayerIndex][otherEntityIndex].Sprite->FrameWidth,
-            .Height = entities[entity->LayerIndex][otherEntityIndex].Sprite->FrameHeight,
-        };
+    if (!clip) {
+        return NULL;
+    }
 
-        if ((otherEntityRect.X < entityRect.X + entityRect.Width) &&
-            (otherEntityRect.X + otherEntityRect.Width > entityRect.X) &&
-            (otherEntityRect.Y < entityRect.Y + entityRect.Height) &&
-            (otherEntityRect.Y + otherEntityRect.Height > entityRect.Y)) {
-            stopTimer();
-            return &entities[entity->LayerIndex][otherEntityIndex];
-        }
+    clip->FirstFrame     = firstFrame;
+    clip->NumberOfFrames = numberOfFrames;
+    clip->FrameSpeed     = frameSpeed;
+    clip->Mode           = clipMode;
+
+    // Clips past the animation frames need their rects, masks and spans too.
+
+    if (sprite->NumberOfFrameRects > 0 && firstFrame + numberOfFrames > sprite->NumberOfFrameRects) {
+        startTimer();
+        buildSpriteFrames(&sprites[sprite->Index]);
+        stopTimer();
     }
 
-    stopTimer();
-    return NULL;
+    return clip;
 }
 
-bool IsEntityOnScreen(const Entity* entity) {
-    if (!entity) {
-        return false;
+// Camera ---------------------------------------------------------------------
+
+static FixedPoint2D cameraPosition;
+static FixedPoint2D layerOffsets[MaxLayers];
+static FixedPoint2D layerParallax[MaxLayers];
+
+void SetCameraPosition(const f16 xPosition, const f16 yPosition) {
+    cameraPosition.X = xPosition;
+    cameraPosition.Y = yPosition;
+}
+
+void SetLayerOffset(const u8 layerIndex, const f16 xOffset, const f16 yOffset) {
+    if (layerIndex >= MaxLayers) {
+        return;
     }
 
-    return (entity->Position.X >= -F16(entity->Sprite->FrameWidth)) &&
-           (entity->Position.Y >= -F16(entity->Sprite->FrameHeight)) &&
-           (entity->Position.X < F16(ScreenWidth)) &&
-           (entity->Position.Y < F16(ScreenHeight));
+    layerOffsets[layerIndex].X = xOffset;
+    layerOffsets[layerIndex].Y = yOffset;
 }
 
-i32 FindEntityIndex(const u8 layerIndex, const u32 typeID, const u32 occurrenceNumber) {
-    if ((layerIndex >= MaxLayers) || (occurrenceNumber == 0)) {
-        return -1;
+void SetLayerParallax(const u8 layerIndex, const f16 xFactor, const f16 yFactor) {
+    if (layerIndex >= MaxLayers) {
+        return;
     }
 
-    startTimer();
+    layerParallax[layerIndex].X = xFactor;
+    layerParallax[layerIndex].Y = yFactor;
+}
 
-    u32 occurrencesFound = 0;
+void GetLayerViewPosition(const u8 layerIndex, FixedPoint2D* viewPosition) {
+    if (layerIndex >= MaxLayers) {
+        viewPosition->X = 0;
+        viewPosition->Y = 0;
+        return;
+    }
 
-    for (u32 entityIndex = 0; entityIndex < numberOfEntities[layerIndex]; entityIndex++) {
-        if (entities[layerIndex][entityIndex].TypeID == typeID) {
-            occurrencesFound++;
+    viewPosition->X = F16Mult(cameraPosition.X, layerParallax[layerIndex].X) + layerOffsets[layerIndex].X;
+    viewPosition->Y = F16Mult(cameraPosition.Y, layerParallax[layerIndex].Y) + layerOffsets[layerIndex].Y;
+}
 
-            if (occurrencesFound == occurrenceNumber) {
-                stopTimer();
-                return entityIndex;
-            }
+// Entities -------------------------------------------------------------------
+
+static u32    numberOfEntities[MaxLayers];
+static u32    entitySlots[MaxLayers][MaxLayerEntities / 32];
+static u8     activeEntities[MaxLayers][MaxLayerEntities];
+static u8     drawOrder[MaxLayers][MaxLayerEntities];
+static u8     layerSortModes[MaxLayers];
+static Entity entities[MaxLayers][MaxLayerEntities];
+
+static inline Entity* getActiveEntity(const u8 layerIndex, const u32 activeIndex) {
+    return &entities[layerIndex][activeEntities[layerIndex][activeIndex]];
+}
+
+static inline bool isEntitySlotUsed(const u8 layerIndex, const u32 slotIndex) {
+    return (entitySlots[layerIndex][slotIndex >> 5] & (1u << (slotIndex & 31))) != 0;
+}
+
+static inline void getEntityRect(const Entity* entity, Rectangle2D* entityRect) {
+    entityRect->X      = F16ToInt(entity->Position.X);
+    entityRect->Y      = F16ToInt(entity->Position.Y);
+    entityRect->Width  = entity->Sprite->FrameWidth;
+    entityRect->Height = entity->Sprite->FrameHeight;
+}
+
+static inline bool rectanglesOverlap(const Rectangle2D* aRect, const Rectangle2D* bRect) {
+    return (bRect->X < aRect->X + aRect->Width) &&
+           (bRect->X + bRect->Width > aRect->X) &&
+           (bRect->Y < aRect->Y + aRect->Height) &&
+           (bRect->Y + bRect->Height > aRect->Y);
+}
+
+static inline bool isPositionInView(const FixedPoint2D* position, const Sprite* sprite, const FixedPoint2D* viewPosition) {
+    f16 viewX = position->X - viewPosition->X;
+    f16 viewY = position->Y - viewPosition->Y;
+
+    return (viewX >= -F16(sprite->FrameWidth)) &&
+           (viewY >= -F16(sprite->FrameHeight)) &&
+           (viewX < F16(ScreenWidth)) &&
+           (viewY < F16(ScreenHeight));
+}
+
+static inline bool isEntityInView(const Entity* entity, const FixedPoint2D* viewPosition) {
+    return isPositionInView(&entity->Position, entity->Sprite, viewPosition);
+}
+
+static void drawSpriteFrame(const Sprite* sprite, const u32 frameIndex, const i32 xPosition, const i32 yPosition) {
+    Rectangle2D frameRect = {
+        .Width  = sprite->FrameWidth,
+        .Height = sprite->FrameHeight,
+    };
+
+    if (frameIndex < sprite->NumberOfFrameRects) {
+        const SpriteFrame* frame = &spriteFrames[sprite->FirstFrameRect + frameIndex];
+
+        frameRect.X = frame->X;
+        frameRect.Y = frame->Y;
+
+        if (sprite->NumberOfSpanWords > 0) {
+            DrawImageSpans(&sprite->Image, &frameRect, &spriteSpans[sprite->FirstSpanWord + frame->SpanOffset], xPosition, yPosition, sprite->TransparentColor);
+            return;
+        }
+    } else {
+        if (sprite->FrameWidth == 0 || sprite->FrameHeight == 0) {
+            return;
         }
+
+        u32 framesPerRow = sprite->Image.Width / sprite->FrameWidth;
+
+        frameRect.X = (frameIndex % framesPerRow) * sprite->FrameWidth;
+        frameRect.Y = (frameIndex / framesPerRow) * sprite->FrameHeight;
     }
 
-    stopTimer();
-    return -1;
+    DrawImageFrame(&sprite->Image, &frameRect, xPosition, yPosition, sprite->TransparentColor);
 }
 
-// Engine ---------------------------------------------------------------------
-
-void InitializeEngine(void) {
-    ResetEngine();
+static void drawEntity(Entity* entity, const FixedPoint2D* drawPosition, const FixedPoint2D* viewPosition) {
+    drawSpriteFrame(entity->Sprite, F16ToInt(entity->FrameIndex), F16ToInt((drawPosition->X - viewPosition->X)), F16ToInt((drawPosition->Y - viewPosition->Y)));
 }
 
-void ResetEngine(void) {
-    startTimer();
+static inline f16 updateSpeed(f16 speedValue, const f16 accelerationValue, const f16 maxSpeedValue, const f16 frictionValue, const f16 speedMultiplier) {
+    if (accelerationValue != 0) {
+        speedValue += F16Mult(accelerationValue, speedMultiplier);
+    }
 
-    for (u32 spriteIndex = 0; spriteIndex < MaxSprites; ++spriteIndex) {
-        sprites[spriteIndex].Index  = spriteIndex;
-        sprites[spriteIndex].IsFree = true;
+    if (frictionValue != 0) {
+        f16 frictionStep = F16Mult(frictionValue, speedMultiplier);
+
+        if (speedValue > 0) {
+            speedValue = F16Max(speedValue - frictionStep, 0);
+        } else if (speedValue < 0) {
+            speedValue = F16Min(speedValue + frictionStep, 0);
+        }
     }
 
-    nextFreeSpriteIndex = 0;
+    if (maxSpeedValue != 0) {
+        speedValue = F16Clamp(speedValue, -maxSpeedValue, maxSpeedValue);
+    }
 
-    for (u32 layerIndex = 0; layerIndex < MaxLayers; layerIndex++) {
-        numberOfEntities[layerIndex] = 0;
+    return speedValue;
+}
 
-        for (u32 entityIndex = 0; entityIndex < MaxLayerEntities; ++entityIndex) {
-            entities[layerIndex][entityIndex].LayerIndex = layerIndex;
-            entities[layerIndex][entityIndex].Index      = entityIndex;
+static inline void applyBounds(f16* positionValue, f16* previousValue, i32* directionValue, const f16 speedValue, const f16 viewValue, const u16 frameSize, const u16 screenSize, const u8 behaviors) {
+    f16 viewPosition = *positionValue - viewValue;
+    i32 motionSign   = (speedValue < 0 ? -*directionValue : *directionValue);
+
+    if (behaviors & BehaviorBounce) {
+        if (viewPosition < 0 && motionSign < 0) {
+            *positionValue  = viewValue;
+            *directionValue = -*directionValue;
+        } else if (viewPosition > F16(screenSize - frameSize) && motionSign > 0) {
+            *positionValue  = viewValue + F16(screenSize - frameSize);
+            *directionValue = -*directionValue;
         }
     }
 
-    stopTimer();
+    if (behaviors & BehaviorWrap) {
+        if (viewPosition <= -F16(frameSize) && motionSign < 0) {
+            *positionValue += F16(screenSize + frameSize);
+            *previousValue += F16(screenSize + frameSize);
+        } else if (viewPosition >= F16(screenSize) && motionSign > 0) {
+            *positionValue -= F16(screenSize + frameSize);
+            *previousValue -= F16(screenSize + frameSize);
+        }
+    }
 }
 
-u64 SyncEngine(const f16 speedMultiplier) {
-    startTimer();
+static inline void updateLifetime(Entity* entity, const f16 speedMultiplier) {
+    entity->Lifetime -= speedMultiplier;
 
-    for (u8 layerIndex = 0; layerIndex < MaxLayers; layerIndex++) {
-        for (u32 entityIndex = 0; entityIndex < numberOfEntities[layerIndex]; ++entityIndex) {
-            Entity* entity = &entities[layerIndex][entityIndex];
+    if (entity->Lifetime <= 0) {
+        entity->ReleaseAfterSync = true;
+    }
+}
 
-            if (entity->Sprite->FrameSpeed != 0) {
-                entity->FrameIndex += F16Mult(entity->Sprite->FrameSpeed, speedMultiplier);
+static void applyBehaviors(Entity* entity, const f16 speedMultiplier, const FixedPoint2D* viewPosition) {
+    if (entity->Lifetime > 0) {
+        updateLifetime(entity, speedMultiplier);
+    }
 
-                if (F16ToInt(entity->FrameIndex) >= entity->Sprite->NumberOfFrames) {
-                    entity->FrameIndex = 0;
-                }
-            }
+    if (entity->Behaviors & (BehaviorBounce | BehaviorWrap)) {
+        applyBounds(&entity->Position.X, &entity->PreviousPosition.X, &entity->Direction.X, entity->Speed.X, viewPosition->X, entity->Sprite->FrameWidth, ScreenWidth, entity->Behaviors);
+        applyBounds(&entity->Position.Y, &entity->PreviousPosition.Y, &entity->Direction.Y, entity->Speed.Y, viewPosition->Y, entity->Sprite->FrameHeight, ScreenHeight, entity->Behaviors);
+    }
 
-            if (entity->Direction.X != 0) {
-                entity->Position.X += F16Mult(entity->Speed.X, speedMultiplier) * entity->Direction.X;
-            }
+    if ((entity->Behaviors & BehaviorReleaseOffscreen) && !isEntityInView(entity, viewPosition)) {
+        entity->ReleaseAfterSync = true;
+    }
+}
 
-            if (entity->Direction.Y != 0) {
-                entity->Position.Y += F16Mult(entity->Speed.Y, speedMultiplier) * entity->Direction.Y;
-            }
+static inline f16 sweepTime(const f16 distance, const f16 delta) {
+    i64 sweptTime = ((i64) distance << 16) / delta;
 
-            drawEntity(entity);
-        }
+    // Anything outside [-4, 4] is already a miss, clamping only keeps it in f16 range.
+
+    if (sweptTime > F16(4)) {
+        return F16(4);
     }
 
-    for (u8 layerIndex = 0; layerIndex < MaxLayers; layerIndex++) {
-        u32 entityIndex = 0;
+    if (sweptTime < -F16(4)) {
+        return -F16(4);
+    }
 
-        while (entityIndex < numberOfEntities[layerIndex]) {
-            if (entities[layerIndex][entityIndex].ReleaseAfterSync) {
-                numberOfEntities[layerIndex]--;
+    return (f16) sweptTime;
+}
 
-                if (entityIndex < numberOfEntities[layerIndex]) {
-                    u32 indexBackup = entities[layerIndex][entityIndex].Index;
-                    memcpy((byte*) &entities[layerIndex][entityIndex], (byte*) &entities[layerIndex][numberOfEntities[layerIndex]], sizeof(Entity));
-                    entities[layerIndex][entityIndex].Index = indexBackup;
-                }
+static bool sweepAxis(const f16 origin, const f16 delta, const f16 minValue, const f16 maxValue, f16* enterTime, f16* exitTime) {
+    if (delta == 0) {
+        return (origin > minValue) && (origin < maxValue);
+    }
 
-                continue;
-            }
+    f16 axisEnter = sweepTime(minValue - origin, delta);
+    f16 axisExit  = sweepTime(maxValue - origin, delta);
 
-            entityIndex++;
-        }
+    if (delta < 0) {
+        f16 swapTime = axisEnter;
+        axisEnter    = axisExit;
+        axisExit     = swapTime;
     }
 
+    *enterTime = F16Max(*enterTime, axisEnter);
+    *exitTime  = F16Min(*exitTime, axisExit);
+    return true;
+}
+
+static bool sweepEntity(const Entity* entity, const Entity* otherEntity, f16* impactTime) {
+    FixedPoint2D relativeDelta = {
+        .X = (entity->Position.X - entity->PreviousPosition.X) - (otherEntity->Position.X - otherEntity->PreviousPosition.X),
+        .Y = (entity->Position.Y - entity->PreviousPosition.Y) - (otherEntity->Position.Y - otherEntity->PreviousPosition.Y),
+    };
+
+    f16 enterTime = -F16(4);
+    f16 exitTime  = F16(4);
+
+    // Sweeps the entity's top-left corner against the other box grown by the entity size (Minkowski sum).
+
+    if (!sweepAxis(entity->PreviousPosition.X, relativeDelta.X, otherEntity->PreviousPosition.X - F16(entity->Sprite->FrameWidth), otherEntity->PreviousPosition.X + F16(otherEntity->Sprite->FrameWidth), &enterTime, &exitTime) ||
+        !sweepAxis(entity->PreviousPosition.Y, relativeDelta.Y, otherEntity->PreviousPosition.Y - F16(entity->Sprite->FrameHeight), otherEntity->PreviousPosition.Y + F16(otherEntity->Sprite->FrameHeight), &enterTime, &exitTime)) {
+        return false;
+    }
+
+    if (enterTime >= exitTime || exitTime <= 0 || enterTime > F16One) {
+        return false;
+    }
+
+    *impactTime = F16Max(enterTime, 0);
+    return true;
+}
+
+static void sweepEntities(const u8 layerIndex) {
+    for (u32 activeIndex = 0; activeIndex < numberOfEntities[layerIndex]; activeIndex++) {
+        Entity* entity = getActiveEntity(layerIndex, activeIndex);
+
+        if (!(entity->Behaviors & BehaviorContinuous) || entity->ReleaseAfterSync || entity->ContactIndex >= 0) {
+            continue;
+        }
+
+        f16 nearestTime = F16One + 1;
+        f16 impactTime;
+
+        for (u32 otherActiveIndex = 0; otherActiveIndex < numberOfEntities[layerIndex]; otherActiveIndex++) {
+            Entity* otherEntity = getActiveEntity(layerIndex, otherActiveIndex);
+
+            if (otherEntity == entity || otherEntity->TypeID != entity->CollisionTypeID || otherEntity->ReleaseAfterSync) {
+                continue;
+            }
+
+            if (sweepEntity(entity, otherEntity, &impactTime) && impactTime < nearestTime) {
+                nearestTime          = impactTime;
+                entity->ContactIndex = otherEntity->Index;
+            }
+        }
+
+        if (entity->ContactIndex >= 0) {
+            entity->ContactTime = nearestTime;
+            entity->Position.X  = entity->PreviousPosition.X + F16Mult(entity->Position.X - entity->PreviousPosition.X, nearestTime);
+            entity->Position.Y  = entity->PreviousPosition.Y + F16Mult(entity->Position.Y - entity->PreviousPosition.Y, nearestTime);
+        }
+    }
+}
+
+static inline const u32* getEntityMaskRow(const Entity* entity, const u32 rowIndex) {
+    const Sprite* sprite     = entity->Sprite;
+    u32           frameIndex = F16ToInt(entity->FrameIndex);
+
+    if (sprite->NumberOfMaskWords == 0 || frameIndex >= sprite->NumberOfFrameRects) {
+        return NULL;
+    }
+
+    u32 wordsPerRow = (sprite->FrameWidth + 31) / 32;
+    return &spriteMasks[sprite->FirstMaskWord + (((frameIndex * sprite->FrameHeight) + rowIndex) * wordsPerRow)];
+}
+
+static inline u32 getMaskBits(const u32* maskRow, const u32 bitOffset, const u32 wordsPerRow) {
+    if (!maskRow) {
+        return 0xFFFFFFFF;
+    }
+
+    u32 wordIndex = bitOffset >> 5;
+    u32 bitShift  = bitOffset & 31;
+    u32 maskBits  = maskRow[wordIndex] >> bitShift;
+
+    if (bitShift != 0 && wordIndex + 1 < wordsPerRow) {
+        maskBits |= maskRow[wordIndex + 1] << (32 - bitShift);
+    }
+
+    return maskBits;
+}
+
+static bool masksOverlap(const Entity* entity, const Rectangle2D* entityRect, const Entity* otherEntity, const Rectangle2D* otherEntityRect) {
+    if (entity->Sprite->NumberOfMaskWords == 0 && otherEntity->Sprite->NumberOfMaskWords == 0) {
+        return true;
+    }
+
+    i32 overlapLeft   = entityRect->X > otherEntityRect->X ? entityRect->X : otherEntityRect->X;
+    i32 overlapTop    = entityRect->Y > otherEntityRect->Y ? entityRect->Y : otherEntityRect->Y;
+    i32 overlapRight  = entityRect->X + entityRect->Width < otherEntityRect->X + otherEntityRect->Width ? entityRect->X + entityRect->Width : otherEntityRect->X + otherEntityRect->Width;
+    i32 overlapBottom = entityRect->Y + entityRect->Height < otherEntityRect->Y + otherEntityRect->Height ? entityRect->Y + entityRect->Height : otherEntityRect->Y + otherEntityRect->Height;
+
+    u32 entityWordsPerRow      = (entity->Sprite->FrameWidth + 31) / 32;
+    u32 otherEntityWordsPerRow = (otherEntity->Sprite->FrameWidth + 31) / 32;
+
+    for (i32 pixelY = overlapTop; pixelY < overlapBottom; pixelY++) {
+        const u32* entityRow      = getEntityMaskRow(entity, pixelY - entityRect->Y);
+        const u32* otherEntityRow = getEntityMaskRow(otherEntity, pixelY - otherEntityRect->Y);
+
+        for (i32 pixelX = overlapLeft; pixelX < overlapRight; pixelX += 32) {
+            u32 remainingBits = overlapRight - pixelX;
+            u32 chunkMask     = remainingBits >= 32 ? 0xFFFFFFFF : (1u << remainingBits) - 1;
+
+            if (getMaskBits(entityRow, pixelX - entityRect->X, entityWordsPerRow) &
+                getMaskBits(otherEntityRow, pixelX - otherEntityRect->X, otherEntityWordsPerRow) &
+                chunkMask) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+static void finishEntityClip(Entity* entity) {
+    const SpriteClip* clip = entity->Clip;
+
+    entity->ClipDirection = 0;
+
+    switch (clip->FinishAction) {
+        case ClipFinishSwitch: {
+            SetEntityClip(entity, clip->NextClipID);
+            break;
+        }
+
+        case ClipFinishRelease: {
+            entity->ReleaseAfterSync = true;
+            break;
+        }
+
+        default: {
+            break;
+        }
+    }
+}
+
+static void updateEntityClip(Entity* entity, const f16 speedMultiplier) {
+    const SpriteClip* clip = entity->Clip;
+
+    if (clip->FrameSpeed == 0 || clip->NumberOfFrames == 0 || entity->ClipDirection == 0) {
+        return;
+    }
+
+    f16 firstFrame = F16(clip->FirstFrame);
+    f16 endFrame   = F16(clip->FirstFrame + clip->NumberOfFrames);
+
+    entity->FrameIndex += F16Mult(clip->FrameSpeed, speedMultiplier) * entity->ClipDirection;
+
+    if (entity->FrameIndex >= firstFrame && entity->FrameIndex < endFrame) {
+        return;
+    }
+
+    switch (clip->Mode) {
+        case ClipOnce: {
+            entity->FrameIndex = endFrame - F16One;
+            finishEntityClip(entity);
+            break;
+        }
+
+        case ClipPingPong: {
+            if (entity->FrameIndex >= endFrame) {
+                entity->FrameIndex    = F16Max(endFrame - F16One - (entity->FrameIndex - endFrame), firstFrame);
+                entity->ClipDirection = -1;
+            } else {
+                entity->FrameIndex    = F16Min(firstFrame + (firstFrame - entity->FrameIndex), endFrame - F16One);
+                entity->ClipDirection = 1;
+            }
+
+            break;
+        }
+
+        default: {
+            entity->FrameIndex = firstFrame + ((entity->FrameIndex - firstFrame) % F16(clip->NumberOfFrames));
+            break;
+        }
+    }
+}
+
+static void resolveEntityPosition(const u8 layerIndex, Entity* entity, u8* resolveStates) {
+    if (resolveStates[entity->Index] != 0) {
+        return;
+    }
+
+    // Parents resolve first (depth-first); a cycle stops at the entity already in progress.
+
+    resolveStates[entity->Index] = 1;
+
+    Entity* parentEntity = &entities[layerIndex][entity->ParentIndex];
+
+    if (parentEntity->ParentIndex >= 0) {
+        resolveEntityPosition(layerIndex, parentEntity, resolveStates);
+    }
+
+    entity->Position.X = parentEntity->Position.X + entity->LocalOffset.X;
+    entity->Position.Y = parentEntity->Position.Y + entity->LocalOffset.Y;
+
+    resolveStates[entity->Index] = 2;
+}
+
+static void resolveAttachedEntities(const u8 layerIndex) {
+    static u8 resolveStates[MaxLayerEntities];
+
+    memset(resolveStates, 0, sizeof(resolveStates));
+
+    for (u32 activeIndex = 0; activeIndex < numberOfEntities[layerIndex]; activeIndex++) {
+        Entity* entity = getActiveEntity(layerIndex, activeIndex);
+
+        if (entity->ParentIndex >= 0) {
+            resolveEntityPosition(layerIndex, entity, resolveStates);
+        }
+    }
+}
+
+// Fixed steps leave entities ahead of the frame, so they are drawn (and sorted) between their last two positions.
+
+static f16 getInterpolatedPosition(const f16 previousPosition, const f16 position) {
+    if (interpolationFactor == F16One) {
+        return position;
+    }
+
+    return previousPosition + F16Mult(position - previousPosition, interpolationFactor);
+}
+
+static i32 getEntitySortKey(const Entity* entity, const u8 sortMode) {
+    if (sortMode == LayerSortDepth) {
+        return entity->Depth;
+    }
+
+    return getInterpolatedPosition(entity->PreviousPosition.Y, entity->Position.Y) + F16(entity->Sprite->FrameHeight);
+}
+
+static void sortDrawOrder(const u8 layerIndex) {
+    static i32 sortKeys[MaxLayerEntities];
+
+    u8* slots    = drawOrder[layerIndex];
+    u8  sortMode = layerSortModes[layerIndex];
+
+    for (u32 orderIndex = 0; orderIndex < numberOfEntities[layerIndex]; orderIndex++) {
+        sortKeys[orderIndex] = getEntitySortKey(&entities[layerIndex][slots[orderIndex]], sortMode);
+    }
+
+    // The order is kept between frames, so it is nearly sorted and the insertion sort stays close to O(n).
+
+    for (u32 orderIndex = 1; orderIndex < numberOfEntities[layerIndex]; orderIndex++) {
+        i32 sortKey   = sortKeys[orderIndex];
+        u8  slotIndex = slots[orderIndex];
+        u32 insertAt  = orderIndex;
+
+        while (insertAt > 0 && sortKeys[insertAt - 1] > sortKey) {
+            sortKeys[insertAt] = sortKeys[insertAt - 1];
+            slots[insertAt]    = slots[insertAt - 1];
+            insertAt--;
+        }
+
+        sortKeys[insertAt] = sortKey;
+        slots[insertAt]    = slotIndex;
+    }
+}
+
+void SetLayerSortMode(const u8 layerIndex, const u8 sortMode) {
+    if (layerIndex >= MaxLayers) {
+        return;
+    }
+
+    layerSortModes[layerIndex] = sortMode;
+}
+
+u32 GetNumberOfEntities(const u8 layerIndex) {
+    return layerIndex < MaxLayers ? numberOfEntities[layerIndex] : 0;
+}
+
+u32 GetEntityIndexLimit(const u8 layerIndex) {
+    if (layerIndex >= MaxLayers) {
+        return 0;
+    }
+
+    for (i32 wordIndex = (MaxLayerEntities / 32) - 1; wordIndex >= 0; wordIndex--) {
+        if (entitySlots[layerIndex][wordIndex] != 0) {
+            return (wordIndex * 32) + 32 - __builtin_clz(entitySlots[layerIndex][wordIndex]);
+        }
+    }
+
+    return 0;
+}
+
+Entity* GetEntity(const u8 layerIndex, const u32 typeID, const Sprite* sprite, const f16 xPosition, const f16 yPosition) {
+    if (layerIndex >= MaxLayers || numberOfEntities[layerIndex] >= MaxLayerEntities) {
+        return 0;
+    }
+
+    startTimer();
+
+    u32 slotIndex = 0;
+
+    for (u32 wordIndex = 0; wordIndex < MaxLayerEntities / 32; wordIndex++) {
+        if (entitySlots[layerIndex][wordIndex] != 0xFFFFFFFF) {
+            slotIndex = (wordIndex * 32) + __builtin_ctz(~entitySlots[layerIndex][wordIndex]);
+            break;
+        }
+    }
+
+    entitySlots[layerIndex][slotIndex >> 5] |= 1u << (slotIndex & 31);
+    activeEntities[layerIndex][numberOfEntities[layerIndex]] = slotIndex;
+    drawOrder[layerIndex][numberOfEntities[layerIndex]++]    = slotIndex;
+
+    Entity* entity = &entities[layerIndex][slotIndex];
+
+    // Zero is left out so plain slot indexes, as used to iterate up to the index limit, never carry a generation.
+
+    entity->Generation  = entity->Generation == 0xFFFF ? 1 : entity->Generation + 1;
+    entity->TypeID      = typeID;
+    entity->Position.X  = xPosition;
+    entity->Position.Y  = yPosition;
+    entity->Sprite      = (Sprite*) sprite;
+    entity->FrameIndex  = 0;
+    entity->Direction.X = 0;
+    entity->Direction.Y = 0;
+    entity->Speed.X     = 0;
+    entity->Speed.Y     = 0;
+
+    entity->Acceleration.X = 0;
+    entity->Acceleration.Y = 0;
+    entity->MaxSpeed.X     = 0;
+    entity->MaxSpeed.Y     = 0;
+    entity->Friction       = 0;
+    entity->Lifetime       = 0;
+    entity->Behaviors      = 0;
+    entity->Depth          = 0;
+
+    entity->PreviousPosition = entity->Position;
+    entity->CollisionTypeID  = 0;
+    entity->ContactIndex     = -1;
+    entity->ContactTime      = 0;
+    entity->ParentIndex      = -1;
+    entity->LocalOffset.X    = 0;
+    entity->LocalOffset.Y    = 0;
+    entity->Clip             = NULL;
+    entity->ClipDirection    = 1;
+
+    entity->ReleaseAfterSync = false;
+
+    stopTimer();
+    return entity;
+}
+
+// Accepts a handle or a plain slot index. A handle whose slot was released and reused since fails the lookup.
+
+Entity* GetEntityByIndex(const u8 layerIndex, const u32 entityIndex) {
+    u32 slotIndex  = entityIndex & ((1u << EntityGenerationShift) - 1);
+    u32 generation = entityIndex >> EntityGenerationShift;
+
+    if (layerIndex >= MaxLayers || slotIndex >= MaxLayerEntities || !isEntitySlotUsed(layerIndex, slotIndex)) {
+        return NULL;
+    }
+
+    if (generation != 0 && generation != entities[layerIndex][slotIndex].Generation) {
+        return NULL;
+    }
+
+    return &entities[layerIndex][slotIndex];
+}
+
+i32 GetEntityHandle(const Entity* entity) {
+    return entity ? (i32) (entity->Index | ((u32) entity->Generation << EntityGenerationShift)) : -1;
+}
+
+void ReleaseEntity(Entity* entity) {
+    if (!entity) {
+        return;
+    }
+
+    entity->ReleaseAfterSync = true;
+}
+
+void SetEntityPosition(Entity* entity, const f16 xPosition, const f16 yPosition) {
+    if (!entity) {
+        return;
+    }
+
+    entity->Position.X         = xPosition;
+    entity->Position.Y         = yPosition;
+    entity->PreviousPosition.X = xPosition;
+    entity->PreviousPosition.Y = yPosition;
+}
+
+void SetEntityClip(Entity* entity, const i32 clipID) {
+    if (!entity) {
+        return;
+    }
+
+    entity->Clip          = clipID >= 0 ? GetSpriteClip(entity->Sprite, clipID) : NULL;
+    entity->ClipDirection = 1;
+
+    if (entity->Clip) {
+        entity->FrameIndex = F16(entity->Clip->FirstFrame);
+    }
+}
+
+SpriteClip* GetEntityClip(Entity* entity) {
+    if (!entity || !entity->Clip) {
+        return NULL;
+    }
+
+    // Releasing a sprite frees its clips, which can then be handed to other sprites.
+
+    if (entity->Clip->IsFree || entity->Clip->SpriteIndex != entity->Sprite->Index) {
+        entity->Clip = NULL;
+    }
+
+    return entity->Clip;
+}
+
+void SetEntityParent(Entity* entity, const Entity* parentEntity, const f16 xOffset, const f16 yOffset) {
+    if (!entity) {
+        return;
+    }
+
+    if (!parentEntity || parentEntity == entity || parentEntity->LayerIndex != entity->LayerIndex) {
+        entity->ParentIndex = -1;
+        return;
+    }
+
+    entity->ParentIndex   = parentEntity->Index;
+    entity->LocalOffset.X = xOffset;
+    entity->LocalOffset.Y = yOffset;
+
+    SetEntityPosition(entity, parentEntity->Position.X + xOffset, parentEntity->Position.Y + yOffset);
+}
+
+Entity* GetCollidingEntity(const Entity* entity, const u32 otherEntityTypeID) {
+    if (!entity) {
+        return NULL;
+    }
+
+    startTimer();
+
+    if ((entity->Behaviors & BehaviorContinuous) && entity->ContactIndex >= 0 && entities[entity->LayerIndex][entity->ContactIndex].TypeID == otherEntityTypeID) {
+        stopTimer();
+        return &entities[entity->LayerIndex][entity->ContactIndex];
+    }
+
+    Rectangle2D entityRect;
+    Rectangle2D otherEntityRect;
+
+    getEntityRect(entity, &entityRect);
+
+    for (u32 otherActiveIndex = 0; otherActiveIndex < numberOfEntities[entity->LayerIndex]; otherActiveIndex++) {
+        Entity* otherEntity = getActiveEntity(entity->LayerIndex, otherActiveIndex);
+
+        if (otherEntity == entity || otherEntity->TypeID != otherEntityTypeID) {
+            continue;
+        }
+
+        getEntityRect(otherEntity, &otherEntityRect);
+
+        if (rectanglesOverlap(&entityRect, &otherEntityRect) &&
+            masksOverlap(entity, &entityRect, otherEntity, &otherEntityRect)) {
+            stopTimer();
+            return otherEntity;
+        }
+    }
+
+    stopTimer();
+    return NULL;
+}
+
+bool IsEntityOnScreen(const Entity* entity) {
+    if (!entity) {
+        return false;
+    }
+
+    FixedPoint2D viewPosition;
+    GetLayerViewPosition(entity->LayerIndex, &viewPosition);
+
+    return isEntityInView(entity, &viewPosition);
+}
+
+i32 FindEntityIndex(const u8 layerIndex, const u32 typeID, const u32 occurrenceNumber) {
+    if ((layerIndex >= MaxLayers) || (occurrenceNumber == 0)) {
+        return -1;
+    }
+
+    startTimer();
+
+    u32 occurrencesFound = 0;
+
+    for (u32 activeIndex = 0; activeIndex < numberOfEntities[layerIndex]; activeIndex++) {
+        if (getActiveEntity(layerIndex, activeIndex)->TypeID == typeID) {
+            occurrencesFound++;
+
+            if (occurrencesFound == occurrenceNumber) {
+                stopTimer();
+                return GetEntityHandle(getActiveEntity(layerIndex, activeIndex));
+            }
+        }
+    }
+
+    stopTimer();
+    return -1;
+}
+
+// Spatial Queries ------------------------------------------------------------
+
+static inline i64 getSquaredDistance(const Entity* entity, const f16 xPosition, const f16 yPosition) {
+    i64 xDistance = (i64) entity->Position.X + (F16(entity->Sprite->FrameWidth) / 2) - xPosition;
+    i64 yDistance = (i64) entity->Position.Y + (F16(entity->Sprite->FrameHeight) / 2) - yPosition;
+
+    return (xDistance * xDistance) + (yDistance * yDistance);
+}
+
+u32 QueryEntitiesInRectangle(const u8 layerIndex, const u32 typeID, const Rectangle2D* rectangle, i32* entityIndexes, const u32 maxResults) {
+    if (layerIndex >= MaxLayers) {
+        return 0;
+    }
+
+    startTimer();
+
+    u32         numberOfResults = 0;
+    Rectangle2D entityRect;
+
+    for (u32 activeIndex = 0; activeIndex < numberOfEntities[layerIndex] && numberOfResults < maxResults; activeIndex++) {
+        Entity* entity = getActiveEntity(layerIndex, activeIndex);
+
+        if (entity->TypeID != typeID || entity->ReleaseAfterSync) {
+            continue;
+        }
+
+        getEntityRect(entity, &entityRect);
+
+        if (rectanglesOverlap(rectangle, &entityRect)) {
+            entityIndexes[numberOfResults++] = GetEntityHandle(entity);
+        }
+    }
+
+    stopTimer();
+    return numberOfResults;
+}
+
+u32 QueryEntitiesInRadius(const u8 layerIndex, const u32 typeID, const f16 xPosition, const f16 yPosition, const f16 radius, i32* entityIndexes, const u32 maxResults) {
+    if (layerIndex >= MaxLayers) {
+        return 0;
+    }
+
+    startTimer();
+
+    u32 numberOfResults = 0;
+    i64 squaredRadius   = (i64) radius * radius;
+
+    for (u32 activeIndex = 0; activeIndex < numberOfEntities[layerIndex] && numberOfResults < maxResults; activeIndex++) {
+        Entity* entity = getActiveEntity(layerIndex, activeIndex);
+
+        if (entity->TypeID != typeID || entity->ReleaseAfterSync) {
+            continue;
+        }
+
+        if (getSquaredDistance(entity, xPosition, yPosition) <= squaredRadius) {
+            entityIndexes[numberOfResults++] = GetEntityHandle(entity);
+        }
+    }
+
+    stopTimer();
+    return numberOfResults;
+}
+
+Entity* GetNearestEntity(const u8 layerIndex, const u32 typeID, const f16 xPosition, const f16 yPosition) {
+    if (layerIndex >= MaxLayers) {
+        return NULL;
+    }
+
+    startTimer();
+
+    Entity* nearestEntity   = NULL;
+    i64     nearestDistance = INT64_MAX;
+
+    for (u32 activeIndex = 0; activeIndex < numberOfEntities[layerIndex]; activeIndex++) {
+        Entity* entity = getActiveEntity(layerIndex, activeIndex);
+
+        if (entity->TypeID != typeID || entity->ReleaseAfterSync) {
+            continue;
+        }
+
+        i64 squaredDistance = getSquaredDistance(entity, xPosition, yPosition);
+
+        if (squaredDistance < nearestDistance) {
+            nearestDistance = squaredDistance;
+            nearestEntity   = entity;
+        }
+    }
+
+    stopTimer();
+    return nearestEntity;
+}
+
+Entity* CastRay(const u8 layerIndex, const u32 typeID, const f16 xPosition, const f16 yPosition, const f16 xDelta, const f16 yDelta, f16* hitTime) {
+    if (layerIndex >= MaxLayers) {
+        return NULL;
+    }
+
+    startTimer();
+
+    Entity* hitEntity   = NULL;
+    f16     nearestTime = F16One + 1;
+
+    for (u32 activeIndex = 0; activeIndex < numberOfEntities[layerIndex]; activeIndex++) {
+        Entity* entity = getActiveEntity(layerIndex, activeIndex);
+
+        if (entity->TypeID != typeID || entity->ReleaseAfterSync) {
+            continue;
+        }
+
+        f16 enterTime = -F16(4);
+        f16 exitTime  = F16(4);
+
+        if (!sweepAxis(xPosition, xDelta, entity->Position.X, entity->Position.X + F16(entity->Sprite->FrameWidth), &enterTime, &exitTime) ||
+            !sweepAxis(yPosition, yDelta, entity->Position.Y, entity->Position.Y + F16(entity->Sprite->FrameHeight), &enterTime, &exitTime)) {
+            continue;
+        }
+
+        if (enterTime >= exitTime || exitTime <= 0 || enterTime > F16One) {
+            continue;
+        }
+
+        enterTime = F16Max(enterTime, 0);
+
+        if (enterTime < nearestTime) {
+            nearestTime = enterTime;
+            hitEntity   = entity;
+        }
+    }
+
+    if (hitEntity && hitTime) {
+        *hitTime = nearestTime;
+    }
+
+    stopTimer();
+    return hitEntity;
+}
+
+// Navigation -----------------------------------------------------------------
+
+#define navigationUnreached 0xFFFFFFFF
+#define navigationUnseen    0xFFFF
+#define navigationClosed    0xFFFE
+
+typedef struct NavigationSearch {
+        u8   Status;
+        bool UseHeuristic;
+        u16  GoalCell;
+        u32  NumberOfOpenCells;
+        u16  OpenCells[MaxNavigationCells];        // Binary min-heap of cells still to expand.
+        u16  OpenPositions[MaxNavigationCells];    // Heap position of each cell, or navigationUnseen / navigationClosed.
+        u32  Scores[MaxNavigationCells];           // Cost from the start (path) or to the target (flow field).
+} NavigationSearch;
+
+static const u8*        navigationCells     = NULL;
+static u16              navigationWidth     = 0;
+static u16              navigationHeight    = 0;
+static u32              navigationBudget    = DefaultNavigationSteps;
+static NavigationSearch pathSearch;
+static NavigationSearch flowSearch;
+
+static inline u32 getNavigationKey(const NavigationSearch* search, const u16 cellIndex) {
+    if (!search->UseHeuristic) {
+        return search->Scores[cellIndex];
+    }
+
+    // Manhattan distance never overestimates, since every walkable cell costs at least 1 to enter.
+
+    i32 xDistance = (cellIndex % navigationWidth) - (search->GoalCell % navigationWidth);
+    i32 yDistance = (cellIndex / navigationWidth) - (search->GoalCell / navigationWidth);
+
+    return search->Scores[cellIndex] + abs(xDistance) + abs(yDistance);
+}
+
+static void siftNavigationCell(NavigationSearch* search, u32 heapIndex) {
+    u16 cellIndex = search->OpenCells[heapIndex];
+    u32 cellKey   = getNavigationKey(search, cellIndex);
+
+    while (heapIndex > 0) {
+        u32 parentIndex = (heapIndex - 1) / 2;
+
+        if (getNavigationKey(search, search->OpenCells[parentIndex]) <= cellKey) {
+            break;
+        }
+
+        search->OpenCells[heapIndex]                        = search->OpenCells[parentIndex];
+        search->OpenPositions[search->OpenCells[heapIndex]] = heapIndex;
+        heapIndex                                           = parentIndex;
+    }
+
+    search->OpenCells[heapIndex]     = cellIndex;
+    search->OpenPositions[cellIndex] = heapIndex;
+}
+
+static u16 popNavigationCell(NavigationSearch* search) {
+    u16 cellIndex = search->OpenCells[0];
+    u16 lastCell  = search->OpenCells[--search->NumberOfOpenCells];
+    u32 lastKey   = getNavigationKey(search, lastCell);
+    u32 heapIndex = 0;
+
+    search->OpenPositions[cellIndex] = navigationClosed;
+
+    while (search->NumberOfOpenCells > 0) {
+        u32 childIndex = (heapIndex * 2) + 1;
+
+        if (childIndex >= search->NumberOfOpenCells) {
+            break;
+        }
+
+        if (childIndex + 1 < search->NumberOfOpenCells &&
+            getNavigationKey(search, search->OpenCells[childIndex + 1]) < getNavigationKey(search, search->OpenCells[childIndex])) {
+            childIndex++;
+        }
+
+        if (getNavigationKey(search, search->OpenCells[childIndex]) >= lastKey) {
+            break;
+        }
+
+        search->OpenCells[heapIndex]                        = search->OpenCells[childIndex];
+        search->OpenPositions[search->OpenCells[heapIndex]] = heapIndex;
+        heapIndex                                           = childIndex;
+    }
+
+    if (search->NumberOfOpenCells > 0) {
+        search->OpenCells[heapIndex]    = lastCell;
+        search->OpenPositions[lastCell] = heapIndex;
+    }
+
+    return cellIndex;
+}
+
+static void openNavigationCell(NavigationSearch* search, const u16 cellIndex, const u32 score) {
+    if (search->OpenPositions[cellIndex] == navigationClosed || score >= search->Scores[cellIndex]) {
+        return;
+    }
+
+    search->Scores[cellIndex] = score;
+
+    if (search->OpenPositions[cellIndex] == navigationUnseen) {
+        search->OpenCells[search->NumberOfOpenCells] = cellIndex;
+        search->OpenPositions[cellIndex]            = search->NumberOfOpenCells++;
+    }
+
+    siftNavigationCell(search, search->OpenPositions[cellIndex]);
+}
+
+static bool startNavigationSearch(NavigationSearch* search, const u16 xCell, const u16 yCell) {
+    if (!navigationCells || xCell >= navigationWidth || yCell >= navigationHeight) {
+        search->Status = NavigationIdle;
+        return false;
+    }
+
+    u32 numberOfCells = navigationWidth * navigationHeight;
+
+    memset(search->OpenPositions, 0xFF, numberOfCells * sizeof(u16));
+    memset(search->Scores, 0xFF, numberOfCells * sizeof(u32));
+
+    search->Status            = NavigationSearching;
+    search->NumberOfOpenCells = 0;
+
+    openNavigationCell(search, (yCell * navigationWidth) + xCell, 0);
+    return true;
+}
+
+static u32 stepNavigationSearch(NavigationSearch* search, u32 budget) {
+    static const i8 neighborOffsets[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+
+    while (budget > 0 && search->Status == NavigationSearching) {
+        if (search->NumberOfOpenCells == 0) {
+            search->Status = search->UseHeuristic ? NavigationNotFound : NavigationFound;
+            break;
+        }
+
+        u16 cellIndex = popNavigationCell(search);
+        budget--;
+
+        if (search->UseHeuristic && cellIndex == search->GoalCell) {
+            search->Status = NavigationFound;
+            break;
+        }
+
+        i32 xCell = cellIndex % navigationWidth;
+        i32 yCell = cellIndex / navigationWidth;
+
+        for (u32 neighborIndex = 0; neighborIndex < 4; neighborIndex++) {
+            i32 xNeighbor = xCell + neighborOffsets[neighborIndex][0];
+            i32 yNeighbor = yCell + neighborOffsets[neighborIndex][1];
+
+            if (xNeighbor < 0 || yNeighbor < 0 || xNeighbor >= navigationWidth || yNeighbor >= navigationHeight) {
+                continue;
+            }
+
+            u16 neighborCell = (yNeighbor * navigationWidth) + xNeighbor;
+
+            if (navigationCells[neighborCell] == 0) {
+                continue;
+            }
+
+            // Paths pay for the cell they enter; flow fields grow backwards from the target, so they pay for the cell they leave.
+
+            u8 stepCost = search->UseHeuristic ? navigationCells[neighborCell] : navigationCells[cellIndex];
+            openNavigationCell(search, neighborCell, search->Scores[cellIndex] + stepCost);
+        }
+    }
+
+    return budget;
+}
+
+static void updateNavigation(void) {
+    u32 budget = navigationBudget;
+
+    if (pathSearch.Status == NavigationSearching) {
+        budget = stepNavigationSearch(&pathSearch, budget);
+    }
+
+    if (flowSearch.Status == NavigationSearching) {
+        stepNavigationSearch(&flowSearch, budget);
+    }
+}
+
+static i32 getPreviousPathCell(const u16 cellIndex) {
+    if (pathSearch.Scores[cellIndex] == 0) {
+        return -1;
+    }
+
+    i32 xCell = cellIndex % navigationWidth;
+    i32 yCell = cellIndex / navigationWidth;
+    u32 score = pathSearch.Scores[cellIndex] - navigationCells[cellIndex];
+
+    if (yCell > 0 && pathSearch.Scores[cellIndex - navigationWidth] == score) {
+        return cellIndex - navigationWidth;
+    }
+
+    if (xCell < navigationWidth - 1 && pathSearch.Scores[cellIndex + 1] == score) {
+        return cellIndex + 1;
+    }
+
+    if (yCell < navigationHeight - 1 && pathSearch.Scores[cellIndex + navigationWidth] == score) {
+        return cellIndex + navigationWidth;
+    }
+
+    if (xCell > 0 && pathSearch.Scores[cellIndex - 1] == score) {
+        return cellIndex - 1;
+    }
+
+    return -1;
+}
+
+bool SetNavigationGrid(const u8* cells, const u16 width, const u16 height) {
+    pathSearch.Status = NavigationIdle;
+    flowSearch.Status = NavigationIdle;
+
+    if (!cells || width == 0 || height == 0 || width * height > MaxNavigationCells) {
+        navigationCells = NULL;
+        return false;
+    }
+
+    navigationCells  = cells;
+    navigationWidth  = width;
+    navigationHeight = height;
+
+    return true;
+}
+
+void SetNavigationBudget(const u32 cellsPerSync) {
+    navigationBudget = cellsPerSync > 0 ? cellsPerSync : DefaultNavigationSteps;
+}
+
+bool StartPathSearch(const u16 startX, const u16 startY, const u16 goalX, const u16 goalY) {
+    if (goalX >= navigationWidth || goalY >= navigationHeight) {
+        pathSearch.Status = NavigationIdle;
+        return false;
+    }
+
+    pathSearch.UseHeuristic = true;
+    pathSearch.GoalCell     = (goalY * navigationWidth) + goalX;
+
+    // A blocked goal would otherwise flood the whole reachable grid before giving up.
+
+    if (navigationCells && navigationCells[pathSearch.GoalCell] == 0) {
+        pathSearch.Status = NavigationNotFound;
+        return false;
+    }
+
+    return startNavigationSearch(&pathSearch, startX, startY);
+}
+
+u8 GetPathStatus(void) {
+    return pathSearch.Status;
+}
+
+u32 GetPath(i32* cellIndexes, const u32 maxCells) {
+    if (pathSearch.Status != NavigationFound) {
+        return 0;
+    }
+
+    startTimer();
+
+    u32 pathLength = 0;
+
+    for (i32 cellIndex = pathSearch.GoalCell; cellIndex >= 0; cellIndex = getPreviousPathCell(cellIndex)) {
+        pathLength++;
+    }
+
+    // Walked backwards from the goal, so the cells are stored from the end of the path and anything past maxCells is dropped.
+
+    u32 pathIndex = pathLength;
+
+    for (i32 cellIndex = pathSearch.GoalCell; cellIndex >= 0; cellIndex = getPreviousPathCell(cellIndex)) {
+        if (--pathIndex < maxCells) {
+            cellIndexes[pathIndex] = cellIndex;
+        }
+    }
+
+    stopTimer();
+    return pathLength < maxCells ? pathLength : maxCells;
+}
+
+bool StartFlowField(const u16 targetX, const u16 targetY) {
+    if (targetX >= navigationWidth || targetY >= navigationHeight) {
+        flowSearch.Status = NavigationIdle;
+        return false;
+    }
+
+    flowSearch.UseHeuristic = false;
+    flowSearch.GoalCell     = (targetY * navigationWidth) + targetX;
+
+    // Flow fields charge the cost of the cell being left, so a blocked target would tie with its neighbours.
+
+    if (navigationCells && navigationCells[flowSearch.GoalCell] == 0) {
+        flowSearch.Status = NavigationNotFound;
+        return false;
+    }
+
+    return startNavigationSearch(&flowSearch, targetX, targetY);
+}
+
+u8 GetFlowFieldStatus(void) {
+    return flowSearch.Status;
+}
+
+i32 GetFlowNextCell(const u16 xCell, const u16 yCell) {
+    if (flowSearch.Status != NavigationFound || xCell >= navigationWidth || yCell >= navigationHeight) {
+        return -1;
+    }
+
+    u16 cellIndex = (yCell * navigationWidth) + xCell;
+    i32 nextCell  = -1;
+    u32 bestScore = flowSearch.Scores[cellIndex];
+
+    if (yCell > 0 && flowSearch.Scores[cellIndex - navigationWidth] < bestScore) {
+        nextCell  = cellIndex - navigationWidth;
+        bestScore = flowSearch.Scores[nextCell];
+    }
+
+    if (xCell < navigationWidth - 1 && flowSearch.Scores[cellIndex + 1] < bestScore) {
+        nextCell  = cellIndex + 1;
+        bestScore = flowSearch.Scores[nextCell];
+    }
+
+    if (yCell < navigationHeight - 1 && flowSearch.Scores[cellIndex + navigationWidth] < bestScore) {
+        nextCell  = cellIndex + navigationWidth;
+        bestScore = flowSearch.Scores[nextCell];
+    }
+
+    if (xCell > 0 && flowSearch.Scores[cellIndex - 1] < bestScore) {
+        nextCell = cellIndex - 1;
+    }
+
+    return nextCell;
+}
+
+// Particles ------------------------------------------------------------------
+
+static Emitter  emitters[MaxEmitters];
+static u32      numberOfParticles[MaxLayers];
+static Particle particles[MaxLayers][MaxLayerParticles];
+
+static inline f16 randomSpread(const f16 spreadValue) {
+    if (spreadValue <= 0) {
+        return 0;
+    }
+
+    return (rand() % (spreadValue * 2 + 1)) - spreadValue;
+}
+
+static void spawnParticle(Emitter* emitter) {
+    if (numberOfParticles[emitter->LayerIndex] >= MaxLayerParticles) {
+        return;
+    }
+
+    Particle* particle = &particles[emitter->LayerIndex][numberOfParticles[emitter->LayerIndex]++];
+
+    particle->Position     = emitter->Position;
+    particle->Velocity.X   = emitter->Velocity.X + randomSpread(emitter->VelocitySpread.X);
+    particle->Velocity.Y   = emitter->Velocity.Y + randomSpread(emitter->VelocitySpread.Y);
+    particle->Age          = 0;
+    particle->EmitterIndex = emitter->Index;
+
+    emitter->NumberOfParticles++;
+}
+
+static void updateEmitters(const f16 speedMultiplier) {
+    for (u32 emitterIndex = 0; emitterIndex < MaxEmitters; emitterIndex++) {
+        Emitter* emitter = &emitters[emitterIndex];
+
+        if (emitter->IsFree || emitter->IsReleased || emitter->SpawnRate == 0) {
+            continue;
+        }
+
+        emitter->SpawnCounter += F16Mult(emitter->SpawnRate, speedMultiplier);
+
+        while (emitter->SpawnCounter >= F16One) {
+            spawnParticle(emitter);
+            emitter->SpawnCounter -= F16One;
+        }
+    }
+}
+
+static void updateParticles(const u8 layerIndex, const f16 speedMultiplier) {
+    u32 particleIndex = 0;
+
+    while (particleIndex < numberOfParticles[layerIndex]) {
+        Particle* particle = &particles[layerIndex][particleIndex];
+        Emitter*  emitter  = &emitters[particle->EmitterIndex];
+
+        particle->Age += speedMultiplier;
+
+        if (particle->Age >= emitter->Lifetime) {
+            emitter->NumberOfParticles--;
+
+            if (emitter->IsReleased && emitter->NumberOfParticles == 0) {
+                emitter->IsFree = true;
+            }
+
+            *particle = particles[layerIndex][--numberOfParticles[layerIndex]];
+            continue;
+        }
+
+        particle->Velocity.X += F16Mult(emitter->Gravity.X, speedMultiplier);
+        particle->Velocity.Y += F16Mult(emitter->Gravity.Y, speedMultiplier);
+        particle->Position.X += F16Mult(particle->Velocity.X, speedMultiplier);
+        particle->Position.Y += F16Mult(particle->Velocity.Y, speedMultiplier);
+
+        particleIndex++;
+    }
+}
+
+static void drawParticles(const u8 layerIndex, const FixedPoint2D* viewPosition) {
+    static f16 colorSteps[MaxEmitters];
+    static f16 frameSteps[MaxEmitters];
+
+    for (u32 emitterIndex = 0; emitterIndex < MaxEmitters; emitterIndex++) {
+        Emitter* emitter = &emitters[emitterIndex];
+
+        if (emitter->LayerIndex != layerIndex || emitter->NumberOfParticles == 0 || emitter->Lifetime <= 0) {
+            continue;
+        }
+
+        colorSteps[emitterIndex] = F16Div(F16(emitter->NumberOfColors), emitter->Lifetime);
+        frameSteps[emitterIndex] = emitter->Sprite ? F16Div(F16(emitter->Sprite->NumberOfFrames), emitter->Lifetime) : 0;
+    }
+
+    for (u32 particleIndex = 0; particleIndex < numberOfParticles[layerIndex]; particleIndex++) {
+        Particle* particle = &particles[layerIndex][particleIndex];
+        Emitter*  emitter  = &emitters[particle->EmitterIndex];
+
+        i32 xPosition = F16ToInt((particle->Position.X - viewPosition->X));
+        i32 yPosition = F16ToInt((particle->Position.Y - viewPosition->Y));
+
+        if (emitter->Sprite) {
+            xPosition -= emitter->Sprite->FrameWidth / 2;
+            yPosition -= emitter->Sprite->FrameHeight / 2;
+
+            if ((xPosition > -emitter->Sprite->FrameWidth) && (yPosition > -emitter->Sprite->FrameHeight) &&
+                (xPosition < ScreenWidth) && (yPosition < ScreenHeight)) {
+                drawSpriteFrame(emitter->Sprite, F16ToInt(F16Mult(particle->Age, frameSteps[particle->EmitterIndex])), xPosition, yPosition);
+            }
+        } else {
+            DrawPixel(xPosition, yPosition, emitter->StartColor + F16ToInt(F16Mult(particle->Age, colorSteps[particle->EmitterIndex])));
+        }
+    }
+}
+
+Emitter* GetEmitter(const u8 layerIndex, const f16 xPosition, const f16 yPosition) {
+    if (layerIndex >= MaxLayers) {
+        return NULL;
+    }
+
+    for (u32 emitterIndex = 0; emitterIndex < MaxEmitters; emitterIndex++) {
+        Emitter* emitter = &emitters[emitterIndex];
+
+        if (!emitter->IsFree) {
+            continue;
+        }
+
+        emitter->IsFree            = false;
+        emitter->IsReleased        = false;
+        emitter->LayerIndex        = layerIndex;
+        emitter->Sprite            = NULL;
+        emitter->Position.X        = xPosition;
+        emitter->Position.Y        = yPosition;
+        emitter->Velocity.X        = 0;
+        emitter->Velocity.Y        = 0;
+        emitter->VelocitySpread.X  = 0;
+        emitter->VelocitySpread.Y  = 0;
+        emitter->Gravity.X         = 0;
+        emitter->Gravity.Y         = 0;
+        emitter->SpawnRate         = 0;
+        emitter->SpawnCounter      = 0;
+        emitter->Lifetime          = F16(TargetFPS);
+        emitter->StartColor        = 0;
+        emitter->NumberOfColors    = 0;
+        emitter->NumberOfParticles = 0;
+
+        return emitter;
+    }
+
+    return NULL;
+}
+
+Emitter* GetEmitterByIndex(const u32 emitterIndex) {
+    if (emitterIndex >= MaxEmitters || emitters[emitterIndex].IsFree || emitters[emitterIndex].IsReleased) {
+        return NULL;
+    }
+
+    return &emitters[emitterIndex];
+}
+
+void ReleaseEmitter(Emitter* emitter) {
+    if (!emitter) {
+        return;
+    }
+
+    emitter->IsReleased = true;
+    emitter->IsFree     = (emitter->NumberOfParticles == 0);
+}
+
+void EmitParticles(Emitter* emitter, const u32 numberOfParticles) {
+    if (!emitter) {
+        return;
+    }
+
+    startTimer();
+
+    for (u32 particleIndex = 0; particleIndex < numberOfParticles; particleIndex++) {
+        spawnParticle(emitter);
+    }
+
+    stopTimer();
+}
+
+u32 GetNumberOfParticles(const u8 layerIndex) {
+    return layerIndex < MaxLayers ? numberOfParticles[layerIndex] : 0;
+}
+
+// Engine ---------------------------------------------------------------------
+
+void InitializeEngine(void) {
+    ResetEngine();
+}
+
+void ResetEngine(void) {
+    startTimer();
+
+    for (u32 spriteIndex = 0; spriteIndex < MaxSprites; ++spriteIndex) {
+        sprites[spriteIndex].Index              = spriteIndex;
+        sprites[spriteIndex].IsFree             = true;
+        sprites[spriteIndex].FirstFrameRect     = 0;
+        sprites[spriteIndex].NumberOfFrameRects = 0;
+        sprites[spriteIndex].UseCollisionMask   = false;
+        sprites[spriteIndex].FirstMaskWord      = 0;
+        sprites[spriteIndex].NumberOfMaskWords  = 0;
+        sprites[spriteIndex].FirstSpanWord      = 0;
+        sprites[spriteIndex].NumberOfSpanWords  = 0;
+    }
+
+    for (u32 clipIndex = 0; clipIndex < MaxSpriteClips; clipIndex++) {
+        spriteClips[clipIndex].IsFree = true;
+    }
+
+    nextFreeSpriteIndex  = 0;
+    numberOfSpriteFrames = 0;
+    numberOfMaskWords    = 0;
+    numberOfSpanWords    = 0;
+
+    cameraPosition.X = 0;
+    cameraPosition.Y = 0;
+
+    useFixedTimestep    = false;
+    stepAccumulator     = 0;
+    interpolationFactor = F16One;
+
+    navigationCells   = NULL;
+    navigationBudget  = DefaultNavigationSteps;
+    pathSearch.Status = NavigationIdle;
+    flowSearch.Status = NavigationIdle;
+
+    for (u32 emitterIndex = 0; emitterIndex < MaxEmitters; emitterIndex++) {
+        emitters[emitterIndex].Index  = emitterIndex;
+        emitters[emitterIndex].IsFree = true;
+    }
+
+    for (u32 layerIndex = 0; layerIndex < MaxLayers; layerIndex++) {
+        numberOfEntities[layerIndex]  = 0;
+        numberOfParticles[layerIndex] = 0;
+        layerSortModes[layerIndex]    = LayerSortNone;
+
+        memset(entitySlots[layerIndex], 0, sizeof(entitySlots[layerIndex]));
+
+        layerOffsets[layerIndex].X  = 0;
+        layerOffsets[layerIndex].Y  = 0;
+        layerParallax[layerIndex].X = F16One;
+        layerParallax[layerIndex].Y = F16One;
+
+        for (u32 entityIndex = 0; entityIndex < MaxLayerEntities; ++entityIndex) {
+            entities[layerIndex][entityIndex].LayerIndex = layerIndex;
+            entities[layerIndex][entityIndex].Index      = entityIndex;
+        }
+    }
+
+    stopTimer();
+}
+
+static void simulateLayer(const u8 layerIndex, const f16 speedMultiplier) {
+    FixedPoint2D viewPosition;
+    GetLayerViewPosition(layerIndex, &viewPosition);
+
+    u32 numberOfContinuous = 0;
+    u32 numberOfAttached   = 0;
+
+    for (u32 activeIndex = 0; activeIndex < numberOfEntities[layerIndex]; ++activeIndex) {
+        Entity* entity = getActiveEntity(layerIndex, activeIndex);
+
+        if (entity->ReleaseAfterSync) {
+            continue;
+        }
+
+        entity->PreviousPosition = entity->Position;
+
+        if (entity->Behaviors & BehaviorContinuous) {
+            numberOfContinuous++;
+        }
+
+        if (GetEntityClip(entity)) {
+            updateEntityClip(entity, speedMultiplier);
+        } else if (entity->Sprite->FrameSpeed != 0) {
+            entity->FrameIndex += F16Mult(entity->Sprite->FrameSpeed, speedMultiplier);
+
+            if (F16ToInt(entity->FrameIndex) >= entity->Sprite->NumberOfFrames) {
+                entity->FrameIndex = 0;
+            }
+        }
+
+        if (entity->ParentIndex >= 0) {
+            numberOfAttached++;
+
+            if (entity->Lifetime > 0) {
+                updateLifetime(entity, speedMultiplier);
+            }
+
+            continue;
+        }
+
+        // A continuous entity stops at its contact for the rest of the sync, since the fixed steps after the
+        // hit are not swept again and would move it through what it hit.
+
+        if ((entity->Behaviors & BehaviorContinuous) && entity->ContactIndex >= 0) {
+            if (entity->Lifetime > 0) {
+                updateLifetime(entity, speedMultiplier);
+            }
+
+            continue;
+        }
+
+        if (entity->Acceleration.X != 0 || entity->Friction != 0 || entity->MaxSpeed.X != 0) {
+            entity->Speed.X = updateSpeed(entity->Speed.X, entity->Acceleration.X, entity->MaxSpeed.X, entity->Friction, speedMultiplier);
+        }
+
+        if (entity->Acceleration.Y != 0 || entity->Friction != 0 || entity->MaxSpeed.Y != 0) {
+            entity->Speed.Y = updateSpeed(entity->Speed.Y, entity->Acceleration.Y, entity->MaxSpeed.Y, entity->Friction, speedMultiplier);
+        }
+
+        if (entity->Direction.X != 0) {
+            entity->Position.X += F16Mult(entity->Speed.X, speedMultiplier) * entity->Direction.X;
+        }
+
+        if (entity->Direction.Y != 0) {
+            entity->Position.Y += F16Mult(entity->Speed.Y, speedMultiplier) * entity->Direction.Y;
+        }
+
+        if (entity->Behaviors != 0 || entity->Lifetime > 0) {
+            applyBehaviors(entity, speedMultiplier, &viewPosition);
+        }
+    }
+
+    if (numberOfAttached > 0) {
+        resolveAttachedEntities(layerIndex);
+    }
+
+    if (numberOfContinuous > 0) {
+        sweepEntities(layerIndex);
+    }
+
+    updateParticles(layerIndex, speedMultiplier);
+}
+
+static void drawLayer(const u8 layerIndex) {
+    FixedPoint2D viewPosition;
+    FixedPoint2D drawPosition;
+
+    GetLayerViewPosition(layerIndex, &viewPosition);
+
+    const u8* slots = activeEntities[layerIndex];
+
+    if (layerSortModes[layerIndex] != LayerSortNone) {
+        sortDrawOrder(layerIndex);
+        slots = drawOrder[layerIndex];
+    }
+
+    for (u32 orderIndex = 0; orderIndex < numberOfEntities[layerIndex]; ++orderIndex) {
+        Entity* entity = &entities[layerIndex][slots[orderIndex]];
+
+        if (entity->ReleaseAfterSync) {
+            continue;
+        }
+
+        drawPosition.X = getInterpolatedPosition(entity->PreviousPosition.X, entity->Position.X);
+        drawPosition.Y = getInterpolatedPosition(entity->PreviousPosition.Y, entity->Position.Y);
+
+        if (isPositionInView(&drawPosition, entity->Sprite, &viewPosition)) {
+            drawEntity(entity, &drawPosition, &viewPosition);
+        }
+    }
+
+    drawParticles(layerIndex, &viewPosition);
+}
+
+static void simulateEngine(const f16 speedMultiplier) {
+    updateEmitters(speedMultiplier);
+
+    for (u8 layerIndex = 0; layerIndex < MaxLayers; layerIndex++) {
+        simulateLayer(layerIndex, speedMultiplier);
+    }
+}
+
+static void releaseEntities(void) {
+    for (u8 layerIndex = 0; layerIndex < MaxLayers; layerIndex++) {
+        u32 numberOfKept     = 0;
+        u32 numberOfReleased = 0;
+
+        // Stable compaction of the active list: slots never move, so guest-held indices stay valid.
+
+        for (u32 activeIndex = 0; activeIndex < numberOfEntities[layerIndex]; activeIndex++) {
+            u8 slotIndex = activeEntities[layerIndex][activeIndex];
+
+            if (entities[layerIndex][slotIndex].ReleaseAfterSync) {
+                entitySlots[layerIndex][slotIndex >> 5] &= ~(1u << (slotIndex & 31));
+                numberOfReleased++;
+                continue;
+            }
+
+            activeEntities[layerIndex][numberOfKept++] = slotIndex;
+        }
+
+        numberOfEntities[layerIndex] = numberOfKept;
+
+        if (numberOfReleased == 0) {
+            continue;
+        }
+
+        numberOfKept = 0;
+
+        for (u32 orderIndex = 0; orderIndex < numberOfEntities[layerIndex] + numberOfReleased; orderIndex++) {
+            u8 slotIndex = drawOrder[layerIndex][orderIndex];
+
+            if (isEntitySlotUsed(layerIndex, slotIndex)) {
+                drawOrder[layerIndex][numberOfKept++] = slotIndex;
+            }
+        }
+
+        for (u32 activeIndex = 0; activeIndex < numberOfEntities[layerIndex]; activeIndex++) {
+            Entity* entity = getActiveEntity(layerIndex, activeIndex);
+
+            if (entity->ContactIndex >= 0 && !isEntitySlotUsed(layerIndex, entity->ContactIndex)) {
+                entity->ContactIndex = -1;
+            }
+
+            if (entity->ParentIndex >= 0 && !isEntitySlotUsed(layerIndex, entity->ParentIndex)) {
+                entity->ParentIndex = -1;
+            }
+        }
+    }
+}
+
+void SetFixedTimestep(const bool isEnabled) {
+    useFixedTimestep    = isEnabled;
+    stepAccumulator     = 0;
+    interpolationFactor = F16One;
+}
+
+// Contacts last for the whole sync, so they are only cleared by a sync that simulates again.
+
+static void clearContacts(void) {
+    for (u8 layerIndex = 0; layerIndex < MaxLayers; layerIndex++) {
+        for (u32 activeIndex = 0; activeIndex < numberOfEntities[layerIndex]; ++activeIndex) {
+            getActiveEntity(layerIndex, activeIndex)->ContactIndex = -1;
+        }
+    }
+}
+
+u64 SyncEngine(const f16 speedMultiplier) {
+    startTimer();
+
+    updateNavigation();
+
+    if (useFixedTimestep) {
+        u32 numberOfSteps = 0;
+
+        stepAccumulator += speedMultiplier;
+
+        while (stepAccumulator >= F16One && numberOfSteps < MaxFixedSteps) {
+            if (numberOfSteps == 0) {
+                clearContacts();
+            }
+
+            simulateEngine(F16One);
+            stepAccumulator -= F16One;
+            numberOfSteps++;
+        }
+
+        // Too far behind: drop the whole steps we could not run instead of spiralling.
+
+        if (stepAccumulator >= F16One) {
+            stepAccumulator &= 0xFFFF;
+        }
+
+        interpolationFactor = stepAccumulator;
+    } else {
+        clearContacts();
+        simulateEngine(speedMultiplier);
+        interpolationFactor = F16One;
+    }
+
+    for (u8 layerIndex = 0; layerIndex < MaxLayers; layerIndex++) {
+        drawLayer(layerIndex);
+    }
+
+    releaseEntities();
+
     stopTimer();
 
     lastBusyTime = busyTime;
@@ -12,7 +12,18 @@
 
 // Sprites --------------------------------------------------------------------
 
-#define MaxSprites 256
+#define MaxSprites         256
+#define MaxSpriteFrames    1024
+#define MaxSpriteMaskWords 1024
+
+#ifndef MaxSpriteSpanWords
+    #define MaxSpriteSpanWords 8192    // Shared by all sprites; sprites that do not fit are drawn per pixel.
+#endif
+
+typedef struct SpriteFrame {
+        u16 X, Y;
+        u16 SpanOffset;
+} SpriteFrame;
 
 typedef struct Sprite {
         u32   Index;
@@ -23,43 +34,187 @@ typedef struct Sprite {
         u16   FrameHeight;
         f16   FrameSpeed;
         u8    NumberOfFrames;
+        u16   FirstFrameRect;
+        u16   NumberOfFrameRects;
+        bool  UseCollisionMask;
+        u16   FirstMaskWord;
+        u16   NumberOfMaskWords;
+        u16   FirstSpanWord;
+        u16   NumberOfSpanWords;
 } Sprite;
 
 Sprite* GetSprite(const Image* image);
 Sprite* GetSpriteByIndex(const u32 spriteIndex);
 void    ReleaseSprite(Sprite* sprite);
 
+void SetSpriteProps(Sprite* sprite, const u16 transparentColor, const u16 frameWidth, const u16 frameHeight);
+void SetSpriteFrames(Sprite* sprite, const u8 numberOfFrames, const f16 frameSpeed);
+void SetSpriteCollisionMask(Sprite* sprite, const bool useCollisionMask);
+
+// Animation Clips ------------------------------------------------------------
+
+#define MaxSpriteClips 128
+
+#define ClipLoop     0
+#define ClipOnce     1
+#define ClipPingPong 2
+
+#define ClipFinishNone    0
+#define ClipFinishSwitch  1
+#define ClipFinishRelease 2
+
+typedef struct SpriteClip {
+        bool IsFree;
+        u8   SpriteIndex;
+        u8   ClipID;
+        u8   Mode;
+        u8   FinishAction;
+        u8   NextClipID;
+        u16  FirstFrame;
+        u16  NumberOfFrames;
+        f16  FrameSpeed;
+} SpriteClip;
+
+SpriteClip* SetSpriteClip(const Sprite* sprite, const u8 clipID, const u16 firstFrame, const u16 numberOfFrames, const f16 frameSpeed, const u8 clipMode);
+SpriteClip* GetSpriteClip(const Sprite* sprite, const u8 clipID);
+
+// Camera ---------------------------------------------------------------------
+
+void SetCameraPosition(const f16 xPosition, const f16 yPosition);
+void SetLayerOffset(const u8 layerIndex, const f16 xOffset, const f16 yOffset);
+void SetLayerParallax(const u8 layerIndex, const f16 xFactor, const f16 yFactor);
+void GetLayerViewPosition(const u8 layerIndex, FixedPoint2D* viewPosition);
+
 // Entities -------------------------------------------------------------------
 
 #define MaxLayers        4
 #define MaxLayerEntities 128
 
+#define EntityGenerationShift 8    // Entity handles keep the slot in the low bits and the slot generation above them.
+
+#define BehaviorBounce           0b00000001    // Reverses direction at the layer view edges.
+#define BehaviorWrap             0b00000010    // Re-enters on the opposite side after leaving the layer view.
+#define BehaviorReleaseOffscreen 0b00000100    // Released as soon as it is outside the layer view.
+#define BehaviorContinuous       0b00001000    // Sweeps its motion against CollisionTypeID entities to avoid tunneling.
+
+#define LayerSortNone  0    // Entities are drawn in spawn order.
+#define LayerSortY     1    // Entities are drawn by the bottom edge of their frame, top to bottom.
+#define LayerSortDepth 2    // Entities are drawn by their Depth, lowest first.
+
 typedef struct Entity {
         u8           LayerIndex;
         u32          Index;
+        u16          Generation;
         u32          TypeID;
         Sprite*      Sprite;
         FixedPoint2D Position;
+        FixedPoint2D PreviousPosition;
         Point2D      Direction;
         FixedPoint2D Speed;
+        FixedPoint2D Acceleration;
+        FixedPoint2D MaxSpeed;
+        f16          Friction;
+        f16          Lifetime;
         f16          FrameIndex;
+        u8           Behaviors;
+        i16          Depth;
+        u32          CollisionTypeID;
+        i32          ContactIndex;
+        f16          ContactTime;
+        i16          ParentIndex;
+        FixedPoint2D LocalOffset;
+        SpriteClip*  Clip;
+        i8           ClipDirection;
         uint         DataAddress;
         bool         ReleaseAfterSync;
 } Entity;
 
-u32     GetNumberOfEntities(const u8 layerIndex);
-Entity* GetEntity(const u8 layerIndex, const u32 typeID, const Sprite* sprite, const f16 xPosition, const f16 yPosition);
-Entity* GetEntityByIndex(const u8 layerIndex, const u32 entityIndex);
-void    ReleaseEntity(Entity* entity);
-Entity* GetCollidingEntity(const Entity* entity, const u32 otherEntityTypeID);
-bool    IsEntityOnScreen(const Entity* entity);
-i32     FindEntityIndex(const u8 layerIndex, const u32 typeID, const u32 occurrenceNumber);
+void        SetLayerSortMode(const u8 layerIndex, const u8 sortMode);
+u32         GetNumberOfEntities(const u8 layerIndex);
+u32         GetEntityIndexLimit(const u8 layerIndex);
+Entity*     GetEntity(const u8 layerIndex, const u32 typeID, const Sprite* sprite, const f16 xPosition, const f16 yPosition);
+Entity*     GetEntityByIndex(const u8 layerIndex, const u32 entityIndex);
+i32         GetEntityHandle(const Entity* entity);
+void        ReleaseEntity(Entity* entity);
+void        SetEntityPosition(Entity* entity, const f16 xPosition, const f16 yPosition);
+void        SetEntityParent(Entity* entity, const Entity* parentEntity, const f16 xOffset, const f16 yOffset);
+void        SetEntityClip(Entity* entity, const i32 clipID);
+SpriteClip* GetEntityClip(Entity* entity);
+Entity*     GetCollidingEntity(const Entity* entity, const u32 otherEntityTypeID);
+bool        IsEntityOnScreen(const Entity* entity);
+i32         FindEntityIndex(const u8 layerIndex, const u32 typeID, const u32 occurrenceNumber);
+
+// Spatial Queries ------------------------------------------------------------
+
+u32     QueryEntitiesInRectangle(const u8 layerIndex, const u32 typeID, const Rectangle2D* rectangle, i32* entityIndexes, const u32 maxResults);
+u32     QueryEntitiesInRadius(const u8 layerIndex, const u32 typeID, const f16 xPosition, const f16 yPosition, const f16 radius, i32* entityIndexes, const u32 maxResults);
+Entity* GetNearestEntity(const u8 layerIndex, const u32 typeID, const f16 xPosition, const f16 yPosition);
+Entity* CastRay(const u8 layerIndex, const u32 typeID, const f16 xPosition, const f16 yPosition, const f16 xDelta, const f16 yDelta, f16* hitTime);
+
+// Navigation -----------------------------------------------------------------
+
+#ifndef MaxNavigationCells
+    #define MaxNavigationCells 1024    // Largest grid (width * height) the preallocated search buffers can hold.
+#endif
+
+#define DefaultNavigationSteps 256    // Cells expanded per SyncEngine call, shared by the path search and the flow field.
+
+#define NavigationIdle      0
+#define NavigationSearching 1
+#define NavigationFound     2
+#define NavigationNotFound  3
+
+bool SetNavigationGrid(const u8* cells, const u16 width, const u16 height);
+void SetNavigationBudget(const u32 cellsPerSync);
+bool StartPathSearch(const u16 startX, const u16 startY, const u16 goalX, const u16 goalY);
+u8   GetPathStatus(void);
+u32  GetPath(i32* cellIndexes, const u32 maxCells);
+bool StartFlowField(const u16 targetX, const u16 targetY);
+u8   GetFlowFieldStatus(void);
+i32  GetFlowNextCell(const u16 xCell, const u16 yCell);
+
+// Particles ------------------------------------------------------------------
+
+#define MaxEmitters       16
+#define MaxLayerParticles 128
+
+typedef struct Emitter {
+        u32          Index;
+        bool         IsFree;
+        bool         IsReleased;
+        u8           LayerIndex;
+        Sprite*      Sprite;
+        FixedPoint2D Position;
+        FixedPoint2D Velocity;
+        FixedPoint2D VelocitySpread;
+        FixedPoint2D Gravity;
+        f16          SpawnRate;
+        f16          SpawnCounter;
+        f16          Lifetime;
+        u8           StartColor;
+        u8           NumberOfColors;
+        u32          NumberOfParticles;
+} Emitter;
+
+typedef struct Particle {
+        FixedPoint2D Position;
+        FixedPoint2D Velocity;
+        f16          Age;
+        u8           EmitterIndex;
+} Particle;
+
+Emitter* GetEmitter(const u8 layerIndex, const f16 xPosition, const f16 yPosition);
+Emitter* GetEmitterByIndex(const u32 emitterIndex);
+void     ReleaseEmitter(Emitter* emitter);
+void     EmitParticles(Emitter* emitter, const u32 numberOfParticles);
+u32      GetNumberOfParticles(const u8 layerIndex);
 
 // Engine ---------------------------------------------------------------------
 
 void InitializeEngine(void);
 void ResetEngine(void);
 u64  SyncEngine(const f16 speedMultiplier);
+void SetFixedTimestep(const bool isEnabled);
 
 u64 GetEngineTime(void);
 
@@ -256,27 +256,34 @@ bool IsButtonJustReleased(const Button buttonIndex) {
 // Graphics -------------------------------------------------------------------
 
 typedef struct graphicsState {
-        u8           drawAnchor;
-        FixedPoint2D drawScale;
-        u16          transparentColor;
-        u16          backgroundColor;
-        u16          foregroundColor;
+        u8            drawAnchor;
+        FixedPoint2D  drawScale;
+        FixedMatrix2D drawTransform;
+        u16           transparentColor;
+        u16           backgroundColor;
+        u16           foregroundColor;
+        bool          hasDrawRemap;
+        u8            drawRemap[ScreenColors];
 } graphicsState;
 
 static graphicsState currentGraphicsState = {
     .drawAnchor       = AnchorDefault,
     .drawScale        = {.X = F16One, .Y = F16One},
+    .drawTransform    = {.A = F16One, .B = 0, .C = 0, .D = F16One},
     .transparentColor = ColorNone,
     .backgroundColor  = ColorNone,
     .foregroundColor  = ColorNone,
+    .hasDrawRemap     = false,
 };
 
 static graphicsState savedGraphicsState = {
     .drawAnchor       = AnchorDefault,
     .drawScale        = {.X = F16One, .Y = F16One},
+    .drawTransform    = {.A = F16One, .B = 0, .C = 0, .D = F16One},
     .transparentColor = ColorNone,
     .backgroundColor  = ColorNone,
     .foregroundColor  = ColorNone,
+    .hasDrawRemap     = false,
 };
 
 static const BitmapFont defaultFont = {
@@ -301,6 +308,72 @@ u8 GetNearestColorIndex(const u8 redValue, const u8 greenValue, const u8 blueVal
     return DrvGpuGetNearestColorIndex(redValue, greenValue, blueValue);
 }
 
+void SetScreenRemap(const u8* remapTable) {
+    DrvGpuSetScreenRemap(remapTable);
+}
+
+void SetDrawRemap(const u8* remapTable) {
+    currentGraphicsState.hasDrawRemap = remapTable != NULL;
+
+    if (remapTable) {
+        memcpy(currentGraphicsState.drawRemap, remapTable, ScreenColors);
+    }
+
+    DrvGpuSetDrawRemap(remapTable);
+}
+
+void SetDeferredRendering(const bool isEnabled) {
+    DrvGpuSetDeferred(isEnabled);
+}
+
+bool BeginStaticLayer(const u8 layerIndex) {
+    return DrvGpuBeginCache(layerIndex);
+}
+
+void EndStaticLayer(const u8 layerIndex) {
+    DrvGpuEndCache(layerIndex);
+}
+
+void InvalidateStaticData(const void* data, const u32 size) {
+    DrvGpuInvalidateCaches(data, size);
+}
+
+void InvalidateStaticLayers(void) {
+    DrvGpuInvalidateCaches(NULL, 0);
+}
+
+void BuildBlendRemap(u8* remapTable, const u8 redValue, const u8 greenValue, const u8 blueValue, const u8 blendAmount) {
+    u8 colorRed, colorGreen, colorBlue;
+
+    for (u32 colorIndex = 0; colorIndex < ScreenColors; colorIndex++) {
+        DrvGpuGetColor(colorIndex, &colorRed, &colorGreen, &colorBlue);
+
+        colorRed   = colorRed + (((redValue - colorRed) * blendAmount) / 255);
+        colorGreen = colorGreen + (((greenValue - colorGreen) * blendAmount) / 255);
+        colorBlue  = colorBlue + (((blueValue - colorBlue) * blendAmount) / 255);
+
+        remapTable[colorIndex] = DrvGpuGetNearestColorIndex(colorRed, colorGreen, colorBlue);
+    }
+}
+
+void BuildCycleRemap(u8* remapTable, const u8 firstColor, const u16 numberOfColors, const i32 cycleOffset) {
+    u32 cycleLength = firstColor + numberOfColors > ScreenColors ? ScreenColors - firstColor : numberOfColors;
+
+    for (u32 colorIndex = 0; colorIndex < ScreenColors; colorIndex++) {
+        remapTable[colorIndex] = colorIndex;
+    }
+
+    if (cycleLength < 2) {
+        return;
+    }
+
+    u32 cycleShift = ((cycleOffset % (i32) cycleLength) + cycleLength) % cycleLength;
+
+    for (u32 cycleIndex = 0; cycleIndex < cycleLength; cycleIndex++) {
+        remapTable[firstColor + cycleIndex] = firstColor + ((cycleIndex + cycleShift) % cycleLength);
+    }
+}
+
 BitmapFont* GetDefaultFont(void) {
     return (BitmapFont*) &defaultFont;
 }
@@ -313,13 +386,16 @@ void ResetDrawState(void) {
     currentGraphicsState.drawAnchor       = AnchorDefault;
     currentGraphicsState.drawScale.X      = F16One;
     currentGraphicsState.drawScale.Y      = F16One;
+    currentGraphicsState.drawTransform    = (FixedMatrix2D) {.A = F16One, .B = 0, .C = 0, .D = F16One};
     currentGraphicsState.transparentColor = ColorNone;
     currentGraphicsState.backgroundColor  = ColorNone;
     currentGraphicsState.foregroundColor  = ColorNone;
+    currentGraphicsState.hasDrawRemap     = false;
 
     DrvGpuSetTransparentColor(currentGraphicsState.transparentColor);
     DrvGpuSetBackgroundColor(currentGraphicsState.backgroundColor);
     DrvGpuSetForegroundColor(currentGraphicsState.foregroundColor);
+    DrvGpuSetDrawRemap(NULL);
 }
 
 void SaveDrawState(void) {
@@ -332,6 +408,7 @@ void RestoreDrawState(void) {
     DrvGpuSetTransparentColor(currentGraphicsState.transparentColor);
     DrvGpuSetBackgroundColor(currentGraphicsState.backgroundColor);
     DrvGpuSetForegroundColor(currentGraphicsState.foregroundColor);
+    DrvGpuSetDrawRemap(currentGraphicsState.hasDrawRemap ? currentGraphicsState.drawRemap : NULL);
 }
 
 static inline void anchorPosition(Point2D* position, const Rectangle2D* rect) {
@@ -371,6 +448,63 @@ static inline void anchorPosition(Point2D* position, const Rectangle2D* rect) {
     }
 }
 
+static inline bool hasDrawTransform(void) {
+    return currentGraphicsState.drawTransform.A != F16One || currentGraphicsState.drawTransform.B != 0 ||
+           currentGraphicsState.drawTransform.C != 0 || currentGraphicsState.drawTransform.D != F16One;
+}
+
+// Transformed images turn around the anchor point of the clip rect, which lands on the draw position.
+
+static void drawTransformed(const Image* image, const int xPosition, const int yPosition, const Rectangle2D* clipRect) {
+    FixedMatrix2D matrix   = currentGraphicsState.drawTransform;
+    Point2D       position = {.X = xPosition, .Y = yPosition};
+    FixedPoint2D  pivot    = {.X = 0, .Y = 0};
+
+    matrix.A = F16Mult(matrix.A, currentGraphicsState.drawScale.X);
+    matrix.C = F16Mult(matrix.C, currentGraphicsState.drawScale.X);
+    matrix.B = F16Mult(matrix.B, currentGraphicsState.drawScale.Y);
+    matrix.D = F16Mult(matrix.D, currentGraphicsState.drawScale.Y);
+
+    switch (currentGraphicsState.drawAnchor & 0b0011) {
+        case AnchorBottom: {
+            pivot.Y = F16(clipRect->Height);
+            break;
+        }
+
+        case AnchorMiddle: {
+            pivot.Y = F16(clipRect->Height) / 2;
+            break;
+        }
+
+        default: {
+            break;
+        }
+    }
+
+    switch (currentGraphicsState.drawAnchor & 0b1100) {
+        case AnchorRight: {
+            pivot.X = F16(clipRect->Width);
+            break;
+        }
+
+        case AnchorCenter: {
+            pivot.X = F16(clipRect->Width) / 2;
+            break;
+        }
+
+        default: {
+            break;
+        }
+    }
+
+    DrvGpuDrawAffine(image, clipRect, &position, &pivot, &matrix);
+}
+
+void DrawPixel(const int xPosition, const int yPosition, const u8 colorIndex) {
+    Point2D position = {.X = xPosition, .Y = yPosition};
+    DrvGpuDrawPixel(&position, colorIndex);
+}
+
 void DrawRectangle(const Rectangle2D* rectangle, const u8 colorIndex) {
     Rectangle2D transformedRectangle = *rectangle;
 
@@ -392,6 +526,11 @@ void DrawRectangle(const Rectangle2D* rectangle, const u8 colorIndex) {
 }
 
 void DrawImage(const Image* image, const int xPosition, const int yPosition, const Rectangle2D* clipRect) {
+    if (hasDrawTransform()) {
+        drawTransformed(image, xPosition, yPosition, clipRect);
+        return;
+    }
+
     if (xPosition >= ScreenWidth || yPosition >= ScreenHeight) {
         return;
     }
@@ -428,6 +567,64 @@ void DrawImage(const Image* image, const int xPosition, const int yPosition, con
     }
 }
 
+void DrawImageFrame(const Image* image, const Rectangle2D* frameRect, const int xPosition, const int yPosition, const u16 transparentColor) {
+    Point2D position = {.X = xPosition, .Y = yPosition};
+    DrvGpuDrawFrame(image, frameRect, &position, transparentColor);
+}
+
+u32 EncodeImageSpans(const Image* image, const Rectangle2D* frameRect, const u16 transparentColor, u16* spanWords, const u32 maxWords) {
+    return DrvGpuEncodeSpans(image, frameRect, transparentColor, spanWords, maxWords);
+}
+
+void DrawImageSpans(const Image* image, const Rectangle2D* frameRect, const u16* spanWords, const int xPosition, const int yPosition, const u16 transparentColor) {
+    Point2D position = {.X = xPosition, .Y = yPosition};
+    DrvGpuDrawSpans(image, frameRect, spanWords, &position, transparentColor);
+}
+
+void DrawTileMapLines(const TileMap* tileMap, const ScanlineTransform* lineTransforms, const int firstRow, const int numberOfRows) {
+    DrvGpuDrawTileMapLines(tileMap, lineTransforms, firstRow, numberOfRows);
+}
+
+void DrawPerspectiveMap(const TileMap* tileMap, const PerspectiveCamera* camera) {
+    static ScanlineTransform lineTransforms[ScreenHeight];
+
+    i32 firstRow = camera->HorizonRow < 0 ? 0 : camera->HorizonRow + 1;
+
+    if (firstRow >= ScreenHeight || camera->Height <= 0 || camera->FocalLength <= 0) {
+        return;
+    }
+
+    float angleRadians = F16ToFloat(camera->Angle) * (float) (M_PI / 180.0);
+    f16   forwardX     = F16FromFloat(sinf(angleRadians));
+    f16   forwardY     = F16FromFloat(-cosf(angleRadians));
+    f16   centerOffset = (F16One / 2) - F16(ScreenWidth / 2);
+
+    // Each row below the horizon sees the map at depth (height * focal length / rows below the horizon),
+    // and spans it sideways, along the camera's right vector, at (height / rows below the horizon) per column.
+
+    for (i32 rowIndex = firstRow; rowIndex < ScreenHeight; rowIndex++) {
+        ScanlineTransform* lineTransform = &lineTransforms[rowIndex];
+
+        f16 pixelScale = F16Div(camera->Height, F16(rowIndex - camera->HorizonRow));
+        f16 rowDepth   = F16Mult(pixelScale, camera->FocalLength);
+
+        lineTransform->XStep = F16Mult(-forwardY, pixelScale);
+        lineTransform->YStep = F16Mult(forwardX, pixelScale);
+        lineTransform->X     = camera->Position.X + F16Mult(forwardX, rowDepth) + F16Mult(lineTransform->XStep, centerOffset);
+        lineTransform->Y     = camera->Position.Y + F16Mult(forwardY, rowDepth) + F16Mult(lineTransform->YStep, centerOffset);
+    }
+
+    DrvGpuDrawTileMapLines(tileMap, &lineTransforms[firstRow], firstRow, ScreenHeight - firstRow);
+}
+
+void SetLineEffects(const LineEffect* lineEffects, const int firstRow, const int numberOfRows) {
+    DrvGpuSetLineEffects(lineEffects, firstRow, numberOfRows);
+}
+
+void ClearLineEffects(void) {
+    DrvGpuSetLineEffects(NULL, 0, ScreenHeight);
+}
+
 void DrawText(const BitmapFont* font, const int xPosition, const int yPosition, const string text) {
     uint    textLength   = strnlen(text, textBufferSize);
     Point2D drawPosition = {.X = xPosition, .Y = yPosition};
@@ -471,9 +668,11 @@ void DrawText(const BitmapFont* font, const int xPosition, const int yPosition,
         targetRect.Height = F16ToInt(F16Mult(F16(targetRect.Height), currentGraphicsState.drawScale.Y));
     }
 
-    u8 drawAnchorBackup = currentGraphicsState.drawAnchor;
+    u8            drawAnchorBackup    = currentGraphicsState.drawAnchor;
+    FixedMatrix2D drawTransformBackup = currentGraphicsState.drawTransform;
 
-    currentGraphicsState.drawAnchor = AnchorDefault;
+    currentGraphicsState.drawAnchor    = AnchorDefault;
+    currentGraphicsState.drawTransform = (FixedMatrix2D) {.A = F16One, .B = 0, .C = 0, .D = F16One};
 
     static uint charRow, charColumn;
     static char currentChar;
@@ -505,7 +704,8 @@ void DrawText(const BitmapFont* font, const int xPosition, const int yPosition,
         }
     }
 
-    currentGraphicsState.drawAnchor = drawAnchorBackup;
+    currentGraphicsState.drawAnchor    = drawAnchorBackup;
+    currentGraphicsState.drawTransform = drawTransformBackup;
 }
 
 void DrawFormattedText(const BitmapFont* font, const int xPosition, const int yPosition, const string message, ...) {
@@ -526,6 +726,21 @@ void SetDrawScale(const f16 xScale, const f16 yScale) {
     currentGraphicsState.drawScale.Y = yScale;
 }
 
+void SetDrawTransform(const FixedMatrix2D* matrix) {
+    currentGraphicsState.drawTransform = *matrix;
+}
+
+void SetDrawRotation(const f16 angleDegrees) {
+    float angleRadians = F16ToFloat(angleDegrees) * (float) (M_PI / 180.0);
+    f16   angleCosine  = F16FromFloat(cosf(angleRadians));
+    f16   angleSine    = F16FromFloat(sinf(angleRadians));
+
+    currentGraphicsState.drawTransform.A = angleCosine;
+    currentGraphicsState.drawTransform.B = -angleSine;
+    currentGraphicsState.drawTransform.C = angleSine;
+    currentGraphicsState.drawTransform.D = angleCosine;
+}
+
 // Sound ----------------------------------------------------------------------
 
 void SetChannelVolume(const SoundChannel channelIndex, const u8 volumePercent) {
@@ -104,6 +104,10 @@ bool IsButtonJustReleased(const Button button);
 #define ScreenPixels (ScreenWidth * ScreenHeight)
 #define ScreenColors 256
 
+#ifndef MaxStaticLayers
+    #define MaxStaticLayers 2    // Each one keeps a whole framebuffer and its draws, targets short on RAM can keep none.
+#endif
+
 #define ColorNone 0xFFFF
 
 typedef struct Point2D {
@@ -122,12 +126,52 @@ typedef struct FixedRectangle2D {
         f16 X, Y, Width, Height;
 } FixedRectangle2D;
 
+// Maps image offsets to screen offsets: x' = (A * x) + (B * y), y' = (C * x) + (D * y).
+
+typedef struct FixedMatrix2D {
+        f16 A, B, C, D;
+} FixedMatrix2D;
+
 typedef struct Image {
         u16 Width;
         u16 Height;
         u8* Data;
 } Image;
 
+// A grid of tile indexes into a tileset image whose tiles are numbered left to right, top to bottom.
+
+typedef struct TileMap {
+        const Image* Tileset;
+        u8           TileSize;    // Tile width and height in pixels, a power of two.
+        u16          Width;       // Map size in tiles, at most 16383 pixels on each side.
+        u16          Height;
+        const u8*    Tiles;
+        bool         Wrap;        // Repeats the map instead of leaving the pixels outside it untouched.
+} TileMap;
+
+// Map pixel coordinates sampled by the first column of a screen row, and their change per column.
+
+typedef struct ScanlineTransform {
+        f16 X, Y;
+        f16 XStep, YStep;
+} ScanlineTransform;
+
+// Applied per screen row when the framebuffer is sent to the display; an all-zero effect leaves the row as drawn.
+
+typedef struct LineEffect {
+        i16 ScrollX;        // Shifts the row right by this many pixels, wrapping around the screen width.
+        i8  RowOffset;      // Shows the framebuffer row this many rows away instead, clamped to the screen.
+        u8  ColorOffset;    // Added to every color index of the row, wrapping at 256.
+} LineEffect;
+
+typedef struct PerspectiveCamera {
+        FixedPoint2D Position;       // Map point under the camera, in pixels.
+        f16          Height;         // Height above the map, in pixels.
+        f16          Angle;          // Viewing direction in degrees, clockwise from the map's -Y axis.
+        f16          FocalLength;    // Distance to the screen, in pixels; larger values narrow the view.
+        i32          HorizonRow;     // Screen row of the horizon, the map is drawn below it.
+} PerspectiveCamera;
+
 typedef struct BitmapFont {
         Image* Image;
         u8     CharWidth;
@@ -140,11 +184,43 @@ void SetForegroundColor(const u16 colorIndex);
 
 u8 GetNearestColorIndex(const u8 redValue, const u8 greenValue, const u8 blueValue);
 
+// Remap tables give the color index to show (screen) or write (draw) for every color index. The screen remap
+// changes the displayed palette, the draw remap applies to every pixel drawn while it is set.
+
+void SetScreenRemap(const u8* remapTable);
+void SetDrawRemap(const u8* remapTable);
+void BuildBlendRemap(u8* remapTable, const u8 redValue, const u8 greenValue, const u8 blueValue, const u8 blendAmount);
+void BuildCycleRemap(u8* remapTable, const u8 firstColor, const u16 numberOfColors, const i32 cycleOffset);
+
+// Deferred rendering records the draws of a frame and rasterizes them at sync in strips of rows, each strip
+// going to the display while the next one is drawn. Images drawn meanwhile must stay unchanged until then.
+
+void SetDeferredRendering(const bool isEnabled);
+
+// Static layers keep a copy of the frame after they are drawn. A layer is drawn between BeginStaticLayer and
+// EndStaticLayer every frame, and when its draws match the last ones and read no data invalidated since, the
+// copy replaces them. Layers are the first draws of a frame, numbered from 0 upwards; BeginStaticLayer returns
+// false for a layer that breaks that order or for targets without layer caches, and the layer is then simply
+// drawn. Data changed in place has to be passed to InvalidateStaticData before the layer reading it is drawn.
+
+bool BeginStaticLayer(const u8 layerIndex);
+void EndStaticLayer(const u8 layerIndex);
+void InvalidateStaticData(const void* data, const u32 size);
+void InvalidateStaticLayers(void);
+
 BitmapFont* GetDefaultFont(void);
 
 void ClearScreen(const u8 colorIndex);
+void DrawPixel(const int xPosition, const int yPosition, const u8 colorIndex);
 void DrawRectangle(const Rectangle2D* rectangle, const u8 colorIndex);
 void DrawImage(const Image* image, const int xPosition, const int yPosition, const Rectangle2D* clipRect);
+void DrawImageFrame(const Image* image, const Rectangle2D* frameRect, const int xPosition, const int yPosition, const u16 transparentColor);
+u32  EncodeImageSpans(const Image* image, const Rectangle2D* frameRect, const u16 transparentColor, u16* spanWords, const u32 maxWords);
+void DrawImageSpans(const Image* image, const Rectangle2D* frameRect, const u16* spanWords, const int xPosition, const int yPosition, const u16 transparentColor);
+void DrawTileMapLines(const TileMap* tileMap, const ScanlineTransform* lineTransforms, const int firstRow, const int numberOfRows);
+void DrawPerspectiveMap(const TileMap* tileMap, const PerspectiveCamera* camera);
+void SetLineEffects(const LineEffect* lineEffects, const int firstRow, const int numberOfRows);
+void ClearLineEffects(void);
 void DrawText(const BitmapFont* font, const int xPosition, const int yPosition, const string text);
 void DrawFormattedText(const BitmapFont* font, const int xPosition, const int yPosition, const string message, ...);
 
@@ -158,6 +234,8 @@ void DrawFormattedText(const BitmapFont* font, const int xPosition, const int yP
 
 void SetDrawAnchor(const u8 anchorMask);
 void SetDrawScale(const f16 xScale, const f16 yScale);
+void SetDrawTransform(const FixedMatrix2D* matrix);
+void SetDrawRotation(const f16 angleDegrees);
 
 void ResetDrawState(void);
 void SaveDrawState(void);
@@ -0,0 +1,154 @@
+//
+// Runtime/Palette.h
+//
+// This file is part of Portatil source code.
+// Copyright 2025 Patrick L. Melo <patrick@patrickmelo.com.br>
+//
+
+#ifndef PORTATIL_PALETTE_H
+#define PORTATIL_PALETTE_H
+
+// Shared by the runtime and the tools, so it only depends on the C library.
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PaletteColors 256
+
+#ifndef ColorLutBits
+    #define ColorLutBits 5    // Bits kept per channel when indexing the RGB lookup table.
+#endif
+
+#define ColorLutSize (1 << (ColorLutBits * 3))
+
+static inline void BuildColorPalette(uint8_t* colorPalette) {
+    static const uint8_t minValues[48] = {
+        0, 0, 0,      // While/Gray/Black
+        32, 0, 0,     // Red
+        32, 8, 0,     // Red/Orange
+        32, 16, 0,    // Orange
+        32, 16, 0,    // Orange/Yellow
+        32, 32, 0,    // Yellow
+        16, 32, 0,    // Lime
+        0, 32, 0,     // Green
+        0, 32, 16,    // Green/Teal
+        0, 32, 32,    // Teal
+        0, 16, 32,    // Teal/Blue
+        0, 0, 32,     // Blue
+        8, 0, 32,     // Blue/Purple
+        16, 0, 32,    // Purple
+        32, 0, 32,    // Fuchsia
+        32, 0, 16,    // Fuchsia/Red
+    };
+
+    static const uint8_t midValues[48] = {
+        128, 128, 128,    // While/Gray/Black
+        255, 0, 0,        // Red
+        255, 64, 0,       // Red/Orange
+        255, 128, 0,      // Orange
+        255, 192, 0,      // Orange/Yellow
+        255, 255, 0,      // Yellow
+        128, 255, 0,      // Lime
+        0, 255, 0,        // Green
+        0, 255, 128,      // Green/Teal
+        0, 255, 255,      // Teal
+        0, 128, 255,      // Teal/Blue
+        0, 0, 255,        // Blue
+        64, 0, 255,       // Blue/Purple
+        128, 0, 255,      // Purple
+        255, 0, 255,      // Fuchsia
+        255, 0, 128,      // Fuchsia/Red
+    };
+
+    static const uint8_t maxValues[48] = {
+        255, 255, 255,    // While/Gray/Black
+        255, 224, 224,    // Red
+        255, 224, 224,    // Red/Orange
+        255, 240, 224,    // Orange
+        255, 255, 224,    // Orange/Yellow
+        255, 255, 224,    // Yellow
+        240, 255, 224,    // Lime
+        224, 255, 224,    // Green
+        224, 255, 240,    // Green/Teal
+        224, 255, 255,    // Teal
+        224, 240, 255,    // Teal/Blue
+        224, 224, 255,    // Blue
+        240, 224, 255,    // Blue/Purple
+        240, 224, 255,    // Purple
+        255, 224, 255,    // Fuchsia
+        255, 224, 240,    // Fuchsia/Red
+    };
+
+    uint32_t colorIndex = 0;
+    float    redStep, greenStep, blueStep;
+
+    for (uint32_t rowIndex = 0; rowIndex < 16; rowIndex++) {
+        redStep   = (float) (midValues[rowIndex * 3] - minValues[rowIndex * 3]) / 7.0f;
+        greenStep = (float) (midValues[rowIndex * 3 + 1] - minValues[rowIndex * 3 + 1]) / 7.0f;
+        blueStep  = (float) (midValues[rowIndex * 3 + 2] - minValues[rowIndex * 3 + 2]) / 7.0f;
+
+        for (uint32_t columnIndex = 0; columnIndex < 8; columnIndex++) {
+            colorPalette[colorIndex * 3]     = minValues[rowIndex * 3] + floor((float) columnIndex * redStep);
+            colorPalette[colorIndex * 3 + 1] = minValues[rowIndex * 3 + 1] + floor((float) columnIndex * greenStep);
+            colorPalette[colorIndex * 3 + 2] = minValues[rowIndex * 3 + 2] + floor((float) columnIndex * blueStep);
+            colorIndex++;
+        }
+
+        redStep   = (float) (maxValues[rowIndex * 3] - midValues[rowIndex * 3]) / 8.0f;
+        greenStep = (float) (maxValues[rowIndex * 3 + 1] - midValues[rowIndex * 3 + 1]) / 8.0f;
+        blueStep  = (float) (maxValues[rowIndex * 3 + 2] - midValues[rowIndex * 3 + 2]) / 8.0f;
+
+        for (uint32_t columnIndex = 1; columnIndex < 9; columnIndex++) {
+            colorPalette[colorIndex * 3]     = midValues[rowIndex * 3] + floor((float) columnIndex * redStep);
+            colorPalette[colorIndex * 3 + 1] = midValues[rowIndex * 3 + 1] + floor((float) columnIndex * greenStep);
+            colorPalette[colorIndex * 3 + 2] = midValues[rowIndex * 3 + 2] + floor((float) columnIndex * blueStep);
+            colorIndex++;
+        }
+    }
+}
+
+static inline uint8_t FindNearestColorIndex(const uint8_t* colorPalette, const uint8_t redValue, const uint8_t greenValue, const uint8_t blueValue) {
+    uint8_t nearestIndex    = 0;
+    int     nearestDistance = INT32_MAX;
+
+    for (uint32_t colorIndex = 0; colorIndex < PaletteColors; ++colorIndex) {
+        int redDiff   = colorPalette[colorIndex * 3] - redValue;
+        int greenDiff = colorPalette[colorIndex * 3 + 1] - greenValue;
+        int blueDiff  = colorPalette[colorIndex * 3 + 2] - blueValue;
+
+        int colorDistance = (2 * redDiff * redDiff) + (4 * greenDiff * greenDiff) + (3 * blueDiff * blueDiff);
+
+        if (colorDistance < nearestDistance) {
+            nearestDistance = colorDistance;
+            nearestIndex    = colorIndex;
+        }
+    }
+
+    return nearestIndex;
+}
+
+static inline uint32_t GetColorLutIndex(const uint8_t redValue, const uint8_t greenValue, const uint8_t blueValue) {
+    return ((redValue >> (8 - ColorLutBits)) << (ColorLutBits * 2)) | ((greenValue >> (8 - ColorLutBits)) << ColorLutBits) | (blueValue >> (8 - ColorLutBits));
+}
+
+// Each table entry holds the palette color nearest to the center of its RGB cell.
+
+static inline uint8_t BuildColorLutEntry(const uint8_t* colorPalette, const uint32_t lutIndex) {
+    const uint32_t channelMask = (1 << ColorLutBits) - 1;
+    const uint32_t cellCenter  = 1 << (7 - ColorLutBits);
+
+    uint8_t redValue   = (((lutIndex >> (ColorLutBits * 2)) & channelMask) << (8 - ColorLutBits)) + cellCenter;
+    uint8_t greenValue = (((lutIndex >> ColorLutBits) & channelMask) << (8 - ColorLutBits)) + cellCenter;
+    uint8_t blueValue  = ((lutIndex & channelMask) << (8 - ColorLutBits)) + cellCenter;
+
+    return FindNearestColorIndex(colorPalette, redValue, greenValue, blueValue);
+}
+
+static inline void BuildColorLut(const uint8_t* colorPalette, uint8_t* colorLut) {
+    for (uint32_t lutIndex = 0; lutIndex < ColorLutSize; lutIndex++) {
+        colorLut[lutIndex] = BuildColorLutEntry(colorPalette, lutIndex);
+    }
+}
+
+#endif    // PORTATIL_PALETTE_H
\ No newline at end of file
@@ -30,6 +30,10 @@ void ShowError(KernelFunction nextStateFunction, const string message) {
     errorMessage = message;
     nextState    = nextStateFunction;
 
+    ClearLineEffects();
+    SetScreenRemap(NULL);
+    SetDeferredRendering(false);
+    InvalidateStaticLayers();
     ChangeState(ErrorState);
 }
 
@@ -342,6 +342,10 @@ void ShellState(const u64 frameTime) {
 
     ClearScreen(0);
     ResetDrawState();
+    ClearLineEffects();
+    SetScreenRemap(NULL);
+    SetDeferredRendering(false);
+    InvalidateStaticLayers();
 
     if (IsStorageAvailable()) {
         drawEntries();
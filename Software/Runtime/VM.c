@@ -14,7 +14,11 @@
 #define maxSyncTime            1000000
 #define errorMessageBufferSize 100
 
+#define writtenPageBits 8    // Guest writes are tracked in pages of 256 bytes for the static layers.
+#define writtenPages    (VirtualMachineMemorySize >> writtenPageBits)
+
 static u8  memoryBlock[VirtualMachineMemorySize];
+static u32 writtenPageMask[writtenPages / 32];
 static u32 programMemoryOffset    = 0;
 static u32 currentProgramSize     = 0;
 static u32 currentInstruction     = 0;
@@ -83,6 +87,34 @@ static inline void setX(const i32 registerIndex, const i32 newValue) {
     }
 }
 
+// Static layers are only restored while the data they read is unchanged, so every page written by the
+// guest, or by syscalls on its behalf, is reported to them before a layer is compared.
+
+static inline void markWritten(const u32 memoryAddress, const u32 size) {
+    u32 lastAddress = memoryAddress + size - 1 < VirtualMachineMemorySize ? memoryAddress + size - 1 : VirtualMachineMemorySize - 1;
+
+    for (u32 pageIndex = memoryAddress >> writtenPageBits; pageIndex <= lastAddress >> writtenPageBits; pageIndex++) {
+        writtenPageMask[pageIndex / 32] |= 1u << (pageIndex % 32);
+    }
+}
+
+static void invalidateWrittenPages(void) {
+    u32 firstPage = 0;
+    u32 pageCount = 0;
+
+    for (u32 pageIndex = 0; pageIndex <= writtenPages; pageIndex++) {
+        if (pageIndex < writtenPages && (writtenPageMask[pageIndex / 32] & (1u << (pageIndex % 32)))) {
+            firstPage = pageCount ? firstPage : pageIndex;
+            pageCount++;
+        } else if (pageCount) {
+            InvalidateStaticData(&memoryBlock[firstPage << writtenPageBits], pageCount << writtenPageBits);
+            pageCount = 0;
+        }
+    }
+
+    memset(writtenPageMask, 0, sizeof(writtenPageMask));
+}
+
 // SysCalls -------------------------------------------------------------------
 
 #define maxSysCalls   256
@@ -98,6 +130,8 @@ static Rectangle2D         targetRetangle   = {.X = 0, .Y = 0, .Width = 0, .Heig
 static u32                 activeLayerIndex = 0;
 static Image               customFontImage  = {.Width = 0, .Height = 0, .Data = NULL};
 static BitmapFont          customFont       = {.Image = NULL, .CharWidth = 0, .CharHeight = 0};
+static Image               tileMapImage     = {.Width = 0, .Height = 0, .Data = NULL};
+static TileMap             tileMap          = {.Tileset = NULL, .TileSize = 0, .Width = 0, .Height = 0, .Tiles = NULL, .Wrap = false};
 
 #define sysCallExit           1
 #define sysCallSync           2
@@ -160,6 +194,66 @@ static BitmapFont          customFont       = {.Image = NULL, .CharWidth = 0, .C
 #define sysCallGetCollidingEntityIndex 83
 #define sysCallFindEntityIndex         84
 #define sysCallIsEntityOnScreen        85
+#define sysCallSetCameraPosition       86
+#define sysCallSetLayerOffset          87
+#define sysCallSetLayerParallax        88
+#define sysCallGetEmitter              89
+#define sysCallReleaseEmitter          90
+#define sysCallSetEmitterPosition      91
+#define sysCallSetEmitterRate          92
+#define sysCallSetEmitterLifetime      93
+#define sysCallSetEmitterVelocity      94
+#define sysCallSetEmitterGravity       95
+#define sysCallSetEmitterColors        96
+#define sysCallSetEmitterSprite        97
+#define sysCallEmitParticles           98
+#define sysCallSetEntityBehaviors      99
+#define sysCallSetEntityAcceleration   100
+#define sysCallSetEntityMaxSpeed       101
+#define sysCallSetEntityFriction       102
+#define sysCallSetEntityLifetime       103
+#define sysCallSetEntityCollisionType  104
+#define sysCallGetEntityContactIndex   105
+#define sysCallGetEntityContactTime    106
+#define sysCallSetSpriteCollisionMask  107
+#define sysCallQueryEntitiesInRect     108
+#define sysCallQueryEntitiesInRadius   109
+#define sysCallGetNearestEntityIndex   110
+#define sysCallCastRay                 111
+#define sysCallSetFixedTimestep        112
+#define sysCallGetEntityIndexLimit     113
+#define sysCallSetEntityParent         114
+#define sysCallGetEntityParent         115
+#define sysCallSetSpriteClip           116
+#define sysCallSetSpriteClipFinish     117
+#define sysCallSetEntityClip           118
+#define sysCallGetEntityClip           119
+#define sysCallSetLayerSortMode        120
+#define sysCallSetEntityDepth          121
+#define sysCallSetNavigationGrid       122
+#define sysCallSetNavigationBudget     123
+#define sysCallStartPathSearch         124
+#define sysCallGetPathStatus           125
+#define sysCallGetPath                 126
+#define sysCallStartFlowField          127
+#define sysCallGetFlowFieldStatus      128
+#define sysCallGetFlowNextCell         129
+#define sysCallSetDrawTransform        130
+#define sysCallSetDrawRotation         131
+#define sysCallSetTileMapImage         132
+#define sysCallSetTileMap              133
+#define sysCallDrawTileMapLines        134
+#define sysCallDrawPerspectiveMap      135
+#define sysCallSetLineEffects          136
+#define sysCallClearLineEffects        137
+#define sysCallSetScreenRemap          138
+#define sysCallSetDrawRemap            139
+#define sysCallBuildBlendRemap         140
+#define sysCallBuildCycleRemap         141
+#define sysCallSetDeferredRendering    142
+#define sysCallBeginStaticLayer        143
+#define sysCallEndStaticLayer          144
+#define sysCallInvalidateStaticLayers  145
 
 static bool sysInvalid(void) {
     return false;
@@ -406,9 +500,7 @@ static bool sysSetSpriteProps(void) {
     Sprite* sprite = GetSpriteByIndex(getX(A0));
 
     if (sprite) {
-        sprite->TransparentColor = getX(A1);
-        sprite->FrameWidth       = getX(A2);
-        sprite->FrameHeight      = getX(A3);
+        SetSpriteProps(sprite, getX(A1), getX(A2), getX(A3));
     }
 
     return true;
@@ -418,13 +510,61 @@ static bool sysSetSpriteFrames(void) {
     Sprite* sprite = GetSpriteByIndex(getX(A0));
 
     if (sprite) {
-        sprite->NumberOfFrames = getX(A1);
-        sprite->FrameSpeed     = F16Div(F16(getX(A2)), F16(TargetFPS));
+        SetSpriteFrames(sprite, getX(A1), F16Div(F16(getX(A2)), F16(TargetFPS)));
+    }
+
+    return true;
+}
+
+static i32* getIndexBuffer(i32 bufferAddress, u32* maxResults) {
+    offsetAddress(bufferAddress);
+
+    if (bufferAddress < 0 || bufferAddress % 4 != 0 || bufferAddress > VirtualMachineMemorySize - 4) {
+        return NULL;
+    }
+
+    if (*maxResults > (u32) (VirtualMachineMemorySize - bufferAddress) / 4) {
+        *maxResults = (VirtualMachineMemorySize - bufferAddress) / 4;
+    }
+
+    if (*maxResults) {
+        markWritten(bufferAddress, *maxResults * 4);
+    }
+
+    return (i32*) (intptr_t) (memoryBlock + (intptr_t) bufferAddress);
+}
+
+static bool sysSetSpriteCollisionMask(void) {
+    Sprite* sprite = GetSpriteByIndex(getX(A0));
+
+    if (sprite) {
+        SetSpriteCollisionMask(sprite, getX(A1) != 0);
+    }
+
+    return true;
+}
+
+static bool sysSetSpriteClip(void) {
+    SetSpriteClip(GetSpriteByIndex(getX(A0)), getX(A1), getX(A2), getX(A3), F16Div(F16(getX(A4)), F16(TargetFPS)), getX(A5));
+    return true;
+}
+
+static bool sysSetSpriteClipFinish(void) {
+    SpriteClip* clip = GetSpriteClip(GetSpriteByIndex(getX(A0)), getX(A1));
+
+    if (clip) {
+        clip->FinishAction = getX(A2);
+        clip->NextClipID   = getX(A3);
     }
 
     return true;
 }
 
+static bool sysSetFixedTimestep(void) {
+    SetFixedTimestep(getX(A0) != 0);
+    return true;
+}
+
 static bool sysSetActiveLayer(void) {
     uint layerIndex = getX(A0);
 
@@ -440,6 +580,11 @@ static bool sysGetNumberOfEntities(void) {
     return true;
 }
 
+static bool sysGetEntityIndexLimit(void) {
+    setX(A0, GetEntityIndexLimit(activeLayerIndex));
+    return true;
+}
+
 static bool sysGetEntity(void) {
     Sprite* sprite = GetSpriteByIndex(getX(A1));
 
@@ -449,7 +594,7 @@ static bool sysGetEntity(void) {
     }
 
     Entity* entity = GetEntity(activeLayerIndex, getX(A0), sprite, getX(A2), getX(A3));
-    setX(A0, entity ? entity->Index : -1);
+    setX(A0, GetEntityHandle(entity));
 
     return true;
 }
@@ -460,13 +605,7 @@ static bool sysReleaseEntity(void) {
 }
 
 static bool sysSetEntityPosition(void) {
-    Entity* entity = GetEntityByIndex(activeLayerIndex, getX(A0));
-
-    if (entity) {
-        entity->Position.X = getX(A1);
-        entity->Position.Y = getX(A2);
-    }
-
+    SetEntityPosition(GetEntityByIndex(activeLayerIndex, getX(A0)), getX(A1), getX(A2));
     return true;
 }
 
@@ -571,7 +710,7 @@ static bool sysGetCollidingEntityIndex(void) {
 
     if (entity) {
         Entity* otherEntity = GetCollidingEntity(entity, getX(A1));
-        setX(A0, otherEntity ? otherEntity->Index : -1);
+        setX(A0, GetEntityHandle(otherEntity));
     } else {
         setX(A0, -1);
     }
@@ -589,6 +728,541 @@ static bool sysIsEntityOnScreen(void) {
     return true;
 }
 
+static bool sysSetCameraPosition(void) {
+    SetCameraPosition(getX(A0), getX(A1));
+    return true;
+}
+
+static bool sysSetLayerOffset(void) {
+    SetLayerOffset(activeLayerIndex, getX(A0), getX(A1));
+    return true;
+}
+
+static bool sysSetLayerParallax(void) {
+    SetLayerParallax(activeLayerIndex, getX(A0), getX(A1));
+    return true;
+}
+
+static bool sysSetLayerSortMode(void) {
+    SetLayerSortMode(activeLayerIndex, getX(A0));
+    return true;
+}
+
+static bool sysGetEmitter(void) {
+    Emitter* emitter = GetEmitter(activeLayerIndex, getX(A0), getX(A1));
+    setX(A0, emitter ? emitter->Index : -1);
+    return true;
+}
+
+static bool sysReleaseEmitter(void) {
+    ReleaseEmitter(GetEmitterByIndex(getX(A0)));
+    return true;
+}
+
+static bool sysSetEmitterPosition(void) {
+    Emitter* emitter = GetEmitterByIndex(getX(A0));
+
+    if (emitter) {
+        emitter->Position.X = getX(A1);
+        emitter->Position.Y = getX(A2);
+    }
+
+    return true;
+}
+
+static bool sysSetEmitterRate(void) {
+    Emitter* emitter = GetEmitterByIndex(getX(A0));
+
+    if (emitter) {
+        emitter->SpawnRate = F16Div(F16(getX(A1)), F16(TargetFPS));
+    }
+
+    return true;
+}
+
+static bool sysSetEmitterLifetime(void) {
+    Emitter* emitter = GetEmitterByIndex(getX(A0));
+
+    if (emitter) {
+        emitter->Lifetime = F16Div(F16(getX(A1)), F16(TargetFrameTimeMs));
+    }
+
+    return true;
+}
+
+static bool sysSetEmitterVelocity(void) {
+    Emitter* emitter = GetEmitterByIndex(getX(A0));
+
+    if (emitter) {
+        emitter->Velocity.X       = getX(A1);
+        emitter->Velocity.Y       = getX(A2);
+        emitter->VelocitySpread.X = getX(A3);
+        emitter->VelocitySpread.Y = getX(A4);
+    }
+
+    return true;
+}
+
+static bool sysSetEmitterGravity(void) {
+    Emitter* emitter = GetEmitterByIndex(getX(A0));
+
+    if (emitter) {
+        emitter->Gravity.X = getX(A1);
+        emitter->Gravity.Y = getX(A2);
+    }
+
+    return true;
+}
+
+static bool sysSetEmitterColors(void) {
+    Emitter* emitter = GetEmitterByIndex(getX(A0));
+
+    if (emitter) {
+        emitter->StartColor     = getX(A1);
+        emitter->NumberOfColors = getX(A2);
+    }
+
+    return true;
+}
+
+static bool sysSetEmitterSprite(void) {
+    Emitter* emitter = GetEmitterByIndex(getX(A0));
+
+    if (emitter) {
+        emitter->Sprite = GetSpriteByIndex(getX(A1));
+    }
+
+    return true;
+}
+
+static bool sysEmitParticles(void) {
+    EmitParticles(GetEmitterByIndex(getX(A0)), getX(A1));
+    return true;
+}
+
+static bool sysSetEntityBehaviors(void) {
+    Entity* entity = GetEntityByIndex(activeLayerIndex, getX(A0));
+
+    if (entity) {
+        entity->Behaviors = getX(A1);
+    }
+
+    return true;
+}
+
+static bool sysSetEntityAcceleration(void) {
+    Entity* entity = GetEntityByIndex(activeLayerIndex, getX(A0));
+
+    if (entity) {
+        entity->Acceleration.X = getX(A1);
+        entity->Acceleration.Y = getX(A2);
+    }
+
+    return true;
+}
+
+static bool sysSetEntityMaxSpeed(void) {
+    Entity* entity = GetEntityByIndex(activeLayerIndex, getX(A0));
+
+    if (entity) {
+        entity->MaxSpeed.X = getX(A1);
+        entity->MaxSpeed.Y = getX(A2);
+    }
+
+    return true;
+}
+
+static bool sysSetEntityFriction(void) {
+    Entity* entity = GetEntityByIndex(activeLayerIndex, getX(A0));
+
+    if (entity) {
+        entity->Friction = getX(A1);
+    }
+
+    return true;
+}
+
+static bool sysSetEntityLifetime(void) {
+    Entity* entity = GetEntityByIndex(activeLayerIndex, getX(A0));
+
+    if (entity) {
+        entity->Lifetime = F16Div(F16(getX(A1)), F16(TargetFrameTimeMs));
+    }
+
+    return true;
+}
+
+static bool sysSetEntityCollisionType(void) {
+    Entity* entity = GetEntityByIndex(activeLayerIndex, getX(A0));
+
+    if (entity) {
+        entity->CollisionTypeID = getX(A1);
+    }
+
+    return true;
+}
+
+static bool sysGetEntityContactIndex(void) {
+    Entity* entity = GetEntityByIndex(activeLayerIndex, getX(A0));
+    setX(A0, entity && (entity->Behaviors & BehaviorContinuous) && entity->ContactIndex >= 0 ? GetEntityHandle(GetEntityByIndex(activeLayerIndex, entity->ContactIndex)) : -1);
+    return true;
+}
+
+static bool sysGetEntityContactTime(void) {
+    Entity* entity = GetEntityByIndex(activeLayerIndex, getX(A0));
+    setX(A0, entity && (entity->Behaviors & BehaviorContinuous) && entity->ContactIndex >= 0 ? entity->ContactTime : F16One);
+    return true;
+}
+
+static bool sysSetEntityParent(void) {
+    Entity* entity       = GetEntityByIndex(activeLayerIndex, getX(A0));
+    Entity* parentEntity = GetEntityByIndex(activeLayerIndex, getX(A1));
+
+    SetEntityParent(entity, parentEntity, getX(A2), getX(A3));
+    return true;
+}
+
+static bool sysSetEntityClip(void) {
+    SetEntityClip(GetEntityByIndex(activeLayerIndex, getX(A0)), getX(A1));
+    return true;
+}
+
+static bool sysGetEntityClip(void) {
+    SpriteClip* clip = GetEntityClip(GetEntityByIndex(activeLayerIndex, getX(A0)));
+    setX(A0, clip ? clip->ClipID : -1);
+    return true;
+}
+
+static bool sysSetEntityDepth(void) {
+    Entity* entity = GetEntityByIndex(activeLayerIndex, getX(A0));
+
+    if (entity) {
+        entity->Depth = getX(A1);
+    }
+
+    return true;
+}
+
+static bool sysGetEntityParent(void) {
+    Entity* entity = GetEntityByIndex(activeLayerIndex, getX(A0));
+    setX(A0, entity && entity->ParentIndex >= 0 ? GetEntityHandle(GetEntityByIndex(activeLayerIndex, entity->ParentIndex)) : -1);
+    return true;
+}
+
+static bool sysQueryEntitiesInRect(void) {
+    Rectangle2D queryRectangle = {
+        .X      = getX(A1),
+        .Y      = getX(A2),
+        .Width  = getX(A3),
+        .Height = getX(A4),
+    };
+
+    u32  maxResults    = getX(A6);
+    i32* entityIndexes = getIndexBuffer(getX(A5), &maxResults);
+
+    if (!entityIndexes) {
+        return false;
+    }
+
+    setX(A0, QueryEntitiesInRectangle(activeLayerIndex, getX(A0), &queryRectangle, entityIndexes, maxResults));
+    return true;
+}
+
+static bool sysQueryEntitiesInRadius(void) {
+    u32  maxResults    = getX(A5);
+    i32* entityIndexes = getIndexBuffer(getX(A4), &maxResults);
+
+    if (!entityIndexes) {
+        return false;
+    }
+
+    setX(A0, QueryEntitiesInRadius(activeLayerIndex, getX(A0), getX(A1), getX(A2), getX(A3), entityIndexes, maxResults));
+    return true;
+}
+
+static bool sysGetNearestEntityIndex(void) {
+    Entity* entity = GetNearestEntity(activeLayerIndex, getX(A0), getX(A1), getX(A2));
+    setX(A0, GetEntityHandle(entity));
+    return true;
+}
+
+static bool sysCastRay(void) {
+    i32 hitTimeAddress = getX(A5);
+    f16 hitTime        = F16One;
+
+    Entity* entity = CastRay(activeLayerIndex, getX(A0), getX(A1), getX(A2), getX(A3), getX(A4), &hitTime);
+
+    if (hitTimeAddress != 0) {
+        offsetAddress(hitTimeAddress);
+
+        if (hitTimeAddress < 0) {
+            return false;
+        }
+
+        assertAddress(hitTimeAddress, 4);
+
+        *(f16*) &memoryBlock[hitTimeAddress] = hitTime;
+        markWritten(hitTimeAddress, 4);
+    }
+
+    setX(A0, GetEntityHandle(entity));
+    return true;
+}
+
+static bool sysSetNavigationGrid(void) {
+    i32 cellsAddress = getX(A0);
+    u32 width        = getX(A1);
+    u32 height       = getX(A2);
+
+    offsetAddress(cellsAddress);
+
+    if (cellsAddress < 0 || width * height > MaxNavigationCells || cellsAddress > VirtualMachineMemorySize - (i32) (width * height)) {
+        setX(A0, false);
+        return true;
+    }
+
+    setX(A0, SetNavigationGrid(&memoryBlock[cellsAddress], width, height));
+    return true;
+}
+
+static bool sysSetNavigationBudget(void) {
+    SetNavigationBudget(getX(A0));
+    return true;
+}
+
+static bool sysStartPathSearch(void) {
+    setX(A0, StartPathSearch(getX(A0), getX(A1), getX(A2), getX(A3)));
+    return true;
+}
+
+static bool sysGetPathStatus(void) {
+    setX(A0, GetPathStatus());
+    return true;
+}
+
+static bool sysGetPath(void) {
+    u32  maxCells    = getX(A1);
+    i32* cellIndexes = getIndexBuffer(getX(A0), &maxCells);
+
+    if (!cellIndexes) {
+        return false;
+    }
+
+    setX(A0, GetPath(cellIndexes, maxCells));
+    return true;
+}
+
+static bool sysStartFlowField(void) {
+    setX(A0, StartFlowField(getX(A0), getX(A1)));
+    return true;
+}
+
+static bool sysGetFlowFieldStatus(void) {
+    setX(A0, GetFlowFieldStatus());
+    return true;
+}
+
+static bool sysGetFlowNextCell(void) {
+    setX(A0, GetFlowNextCell(getX(A0), getX(A1)));
+    return true;
+}
+
+static bool sysSetDrawTransform(void) {
+    FixedMatrix2D matrix = {.A = getX(A0), .B = getX(A1), .C = getX(A2), .D = getX(A3)};
+    SetDrawTransform(&matrix);
+    return true;
+}
+
+static bool sysSetDrawRotation(void) {
+    SetDrawRotation(getX(A0));
+    return true;
+}
+
+static bool sysSetTileMapImage(void) {
+    i32 dataAddress = getX(A2);
+    u32 imageWidth  = getX(A0);
+    u32 imageHeight = getX(A1);
+
+    offsetAddress(dataAddress);
+
+    if (dataAddress < 0 || dataAddress > VirtualMachineMemorySize || imageWidth > 0xFFFF || imageHeight > 0xFFFF ||
+        (u64) imageWidth * imageHeight > (u64) (VirtualMachineMemorySize - dataAddress)) {
+        tileMap.Tileset = NULL;
+        setX(A0, false);
+        return true;
+    }
+
+    tileMapImage.Width  = imageWidth;
+    tileMapImage.Height = imageHeight;
+    tileMapImage.Data   = &memoryBlock[dataAddress];
+    tileMap.Tileset     = &tileMapImage;
+    tileMap.TileSize    = getX(A3);
+
+    setX(A0, true);
+    return true;
+}
+
+static bool sysSetTileMap(void) {
+    i32 tilesAddress = getX(A2);
+    u32 mapWidth     = getX(A0);
+    u32 mapHeight    = getX(A1);
+
+    offsetAddress(tilesAddress);
+
+    if (tilesAddress < 0 || tilesAddress > VirtualMachineMemorySize || mapWidth > 0xFFFF || mapHeight > 0xFFFF ||
+        (u64) mapWidth * mapHeight > (u64) (VirtualMachineMemorySize - tilesAddress)) {
+        tileMap.Tiles = NULL;
+        setX(A0, false);
+        return true;
+    }
+
+    tileMap.Width  = mapWidth;
+    tileMap.Height = mapHeight;
+    tileMap.Tiles  = &memoryBlock[tilesAddress];
+    tileMap.Wrap   = getX(A3) != 0;
+
+    setX(A0, true);
+    return true;
+}
+
+static bool sysDrawTileMapLines(void) {
+    i32 linesAddress = getX(A0);
+    i32 firstRow     = getX(A1);
+    u32 numberOfRows = getX(A2);
+
+    offsetAddress(linesAddress);
+
+    if (numberOfRows > ScreenHeight) {
+        numberOfRows = ScreenHeight;
+    }
+
+    if (linesAddress < 0 || linesAddress % 4 != 0 ||
+        linesAddress > VirtualMachineMemorySize - (i32) (numberOfRows * sizeof(ScanlineTransform))) {
+        return false;
+    }
+
+    DrawTileMapLines(&tileMap, (const ScanlineTransform*) (intptr_t) (memoryBlock + (intptr_t) linesAddress), firstRow, numberOfRows);
+    return true;
+}
+
+static bool sysDrawPerspectiveMap(void) {
+    PerspectiveCamera camera = {
+        .Position    = {.X = getX(A0), .Y = getX(A1)},
+        .Height      = getX(A2),
+        .Angle       = getX(A3),
+        .HorizonRow  = getX(A4),
+        .FocalLength = getX(A5),
+    };
+
+    DrawPerspectiveMap(&tileMap, &camera);
+    return true;
+}
+
+static bool sysSetLineEffects(void) {
+    i32 effectsAddress = getX(A0);
+    i32 firstRow       = getX(A1);
+    u32 numberOfRows   = getX(A2);
+
+    offsetAddress(effectsAddress);
+
+    if (numberOfRows > ScreenHeight) {
+        numberOfRows = ScreenHeight;
+    }
+
+    if (effectsAddress < 0 || effectsAddress % 2 != 0 ||
+        effectsAddress > VirtualMachineMemorySize - (i32) (numberOfRows * sizeof(LineEffect))) {
+        return false;
+    }
+
+    SetLineEffects((const LineEffect*) (intptr_t) (memoryBlock + (intptr_t) effectsAddress), firstRow, numberOfRows);
+    return true;
+}
+
+static bool sysClearLineEffects(void) {
+    ClearLineEffects();
+    return true;
+}
+
+static u8* getRemapTable(i32 tableAddress) {
+    offsetAddress(tableAddress);
+
+    if (tableAddress < 0 || tableAddress > VirtualMachineMemorySize - ScreenColors) {
+        return NULL;
+    }
+
+    return &memoryBlock[tableAddress];
+}
+
+static bool sysSetScreenRemap(void) {
+    i32 tableAddress = getX(A0);
+    u8* remapTable   = tableAddress ? getRemapTable(tableAddress) : NULL;
+
+    if (tableAddress && !remapTable) {
+        return false;
+    }
+
+    SetScreenRemap(remapTable);
+    return true;
+}
+
+static bool sysSetDrawRemap(void) {
+    i32 tableAddress = getX(A0);
+    u8* remapTable   = tableAddress ? getRemapTable(tableAddress) : NULL;
+
+    if (tableAddress && !remapTable) {
+        return false;
+    }
+
+    SetDrawRemap(remapTable);
+    return true;
+}
+
+static bool sysBuildBlendRemap(void) {
+    u8* remapTable = getRemapTable(getX(A0));
+
+    if (!remapTable) {
+        return false;
+    }
+
+    BuildBlendRemap(remapTable, getX(A1), getX(A2), getX(A3), getX(A4));
+    markWritten(remapTable - memoryBlock, ScreenColors);
+    return true;
+}
+
+static bool sysBuildCycleRemap(void) {
+    u8* remapTable = getRemapTable(getX(A0));
+
+    if (!remapTable) {
+        return false;
+    }
+
+    BuildCycleRemap(remapTable, getX(A1), getX(A2), getX(A3));
+    markWritten(remapTable - memoryBlock, ScreenColors);
+    return true;
+}
+
+static bool sysSetDeferredRendering(void) {
+    SetDeferredRendering(getX(A0) != 0);
+    return true;
+}
+
+static bool sysBeginStaticLayer(void) {
+    invalidateWrittenPages();
+    setX(A0, BeginStaticLayer(getX(A0)));
+    return true;
+}
+
+static bool sysEndStaticLayer(void) {
+    invalidateWrittenPages();
+    EndStaticLayer(getX(A0));
+    return true;
+}
+
+static bool sysInvalidateStaticLayers(void) {
+    InvalidateStaticLayers();
+    return true;
+}
+
 void initializeSysCalls(void) {
     defaultFont = GetDefaultFont();
 
@@ -657,6 +1331,66 @@ void initializeSysCalls(void) {
     sysCallTable[sysCallGetCollidingEntityIndex] = sysGetCollidingEntityIndex;
     sysCallTable[sysCallFindEntityIndex]         = sysFindEntityIndex;
     sysCallTable[sysCallIsEntityOnScreen]        = sysIsEntityOnScreen;
+    sysCallTable[sysCallSetCameraPosition]       = sysSetCameraPosition;
+    sysCallTable[sysCallSetLayerOffset]          = sysSetLayerOffset;
+    sysCallTable[sysCallSetLayerParallax]        = sysSetLayerParallax;
+    sysCallTable[sysCallGetEmitter]              = sysGetEmitter;
+    sysCallTable[sysCallReleaseEmitter]          = sysReleaseEmitter;
+    sysCallTable[sysCallSetEmitterPosition]      = sysSetEmitterPosition;
+    sysCallTable[sysCallSetEmitterRate]          = sysSetEmitterRate;
+    sysCallTable[sysCallSetEmitterLifetime]      = sysSetEmitterLifetime;
+    sysCallTable[sysCallSetEmitterVelocity]      = sysSetEmitterVelocity;
+    sysCallTable[sysCallSetEmitterGravity]       = sysSetEmitterGravity;
+    sysCallTable[sysCallSetEmitterColors]        = sysSetEmitterColors;
+    sysCallTable[sysCallSetEmitterSprite]        = sysSetEmitterSprite;
+    sysCallTable[sysCallEmitParticles]           = sysEmitParticles;
+    sysCallTable[sysCallSetEntityBehaviors]      = sysSetEntityBehaviors;
+    sysCallTable[sysCallSetEntityAcceleration]   = sysSetEntityAcceleration;
+    sysCallTable[sysCallSetEntityMaxSpeed]       = sysSetEntityMaxSpeed;
+    sysCallTable[sysCallSetEntityFriction]       = sysSetEntityFriction;
+    sysCallTable[sysCallSetEntityLifetime]       = sysSetEntityLifetime;
+    sysCallTable[sysCallSetEntityCollisionType]  = sysSetEntityCollisionType;
+    sysCallTable[sysCallGetEntityContactIndex]   = sysGetEntityContactIndex;
+    sysCallTable[sysCallGetEntityContactTime]    = sysGetEntityContactTime;
+    sysCallTable[sysCallSetSpriteCollisionMask]  = sysSetSpriteCollisionMask;
+    sysCallTable[sysCallQueryEntitiesInRect]     = sysQueryEntitiesInRect;
+    sysCallTable[sysCallQueryEntitiesInRadius]   = sysQueryEntitiesInRadius;
+    sysCallTable[sysCallGetNearestEntityIndex]   = sysGetNearestEntityIndex;
+    sysCallTable[sysCallCastRay]                 = sysCastRay;
+    sysCallTable[sysCallSetFixedTimestep]        = sysSetFixedTimestep;
+    sysCallTable[sysCallGetEntityIndexLimit]     = sysGetEntityIndexLimit;
+    sysCallTable[sysCallSetEntityParent]         = sysSetEntityParent;
+    sysCallTable[sysCallGetEntityParent]         = sysGetEntityParent;
+    sysCallTable[sysCallSetSpriteClip]           = sysSetSpriteClip;
+    sysCallTable[sysCallSetSpriteClipFinish]     = sysSetSpriteClipFinish;
+    sysCallTable[sysCallSetEntityClip]           = sysSetEntityClip;
+    sysCallTable[sysCallGetEntityClip]           = sysGetEntityClip;
+    sysCallTable[sysCallSetLayerSortMode]        = sysSetLayerSortMode;
+    sysCallTable[sysCallSetEntityDepth]          = sysSetEntityDepth;
+    sysCallTable[sysCallSetNavigationGrid]       = sysSetNavigationGrid;
+    sysCallTable[sysCallSetNavigationBudget]     = sysSetNavigationBudget;
+    sysCallTable[sysCallStartPathSearch]         = sysStartPathSearch;
+    sysCallTable[sysCallGetPathStatus]           = sysGetPathStatus;
+    sysCallTable[sysCallGetPath]                 = sysGetPath;
+    sysCallTable[sysCallStartFlowField]          = sysStartFlowField;
+    sysCallTable[sysCallGetFlowFieldStatus]      = sysGetFlowFieldStatus;
+    sysCallTable[sysCallGetFlowNextCell]         = sysGetFlowNextCell;
+    sysCallTable[sysCallSetDrawTransform]        = sysSetDrawTransform;
+    sysCallTable[sysCallSetDrawRotation]         = sysSetDrawRotation;
+    sysCallTable[sysCallSetTileMapImage]         = sysSetTileMapImage;
+    sysCallTable[sysCallSetTileMap]              = sysSetTileMap;
+    sysCallTable[sysCallDrawTileMapLines]        = sysDrawTileMapLines;
+    sysCallTable[sysCallDrawPerspectiveMap]      = sysDrawPerspectiveMap;
+    sysCallTable[sysCallSetLineEffects]          = sysSetLineEffects;
+    sysCallTable[sysCallClearLineEffects]        = sysClearLineEffects;
+    sysCallTable[sysCallSetScreenRemap]          = sysSetScreenRemap;
+    sysCallTable[sysCallSetDrawRemap]            = sysSetDrawRemap;
+    sysCallTable[sysCallBuildBlendRemap]         = sysBuildBlendRemap;
+    sysCallTable[sysCallBuildCycleRemap]         = sysBuildCycleRemap;
+    sysCallTable[sysCallSetDeferredRendering]    = sysSetDeferredRendering;
+    sysCallTable[sysCallBeginStaticLayer]        = sysBeginStaticLayer;
+    sysCallTable[sysCallEndStaticLayer]          = sysEndStaticLayer;
+    sysCallTable[sysCallInvalidateStaticLayers]  = sysInvalidateStaticLayers;
 }
 
 static bool doSysCall(void) {
@@ -1303,6 +2037,7 @@ static bool opStore() {
         }
     }
 
+    markWritten(memoryAddress, 1u << f3);
     return true;
 }
 
@@ -1457,6 +2192,7 @@ static bool resetVirtualMachine(const u32 entrypointAddress, const u32 memoryOff
     }
 
     memset(memoryBlock, 0, VirtualMachineMemorySize);
+    memset(writtenPageMask, 0xFF, sizeof(writtenPageMask));
     memset(registers, 0, sizeof(registers));
 
     currentInstruction     = 0;
@@ -144,6 +144,27 @@ typedef struct Rectangle2D {
         int X, Y, Width, Height;
 } Rectangle2D;
 
+// Maps image offsets to screen offsets: x' = (A * x) + (B * y), y' = (C * x) + (D * y).
+
+typedef struct FixedMatrix2D {
+        f16 A, B, C, D;
+} FixedMatrix2D;
+
+// Map pixel coordinates sampled by the first column of a screen row, and their change per column.
+
+typedef struct ScanlineTransform {
+        f16 X, Y;
+        f16 XStep, YStep;
+} ScanlineTransform;
+
+// Applied per screen row when the frame is displayed; an all-zero effect leaves the row as drawn.
+
+typedef struct LineEffect {
+        short       ScrollX;        // Shifts the row right by this many pixels, wrapping around the screen width.
+        signed char RowOffset;      // Shows the row this many rows away instead, clamped to the screen.
+        byte        ColorOffset;    // Added to every color index of the row, wrapping at 256.
+} LineEffect;
+
 typedef struct Image {
         uint  Width;
         uint  Height;
@@ -159,6 +180,8 @@ extern void SysSetForegroundColor(const uint colorIndex);
 
 extern void SysSetDrawAnchor(const uint anchorMask);
 extern void SysSetDrawScale(const f16 xScale, const f16 yScale);
+extern void SysSetDrawTransform(const f16 aValue, const f16 bValue, const f16 cValue, const f16 dValue);
+extern void SysSetDrawRotation(const f16 angleDegrees);
 
 extern void SysSetTargetPosition(const int xPosition, const int yPosition);
 extern void SysSetSourceRectangle(const int xPosition, const int yPosition, const uint sizeWidth, const uint sizeHeight);
@@ -170,6 +193,25 @@ extern void SysDrawImage(const uint imageWidth, const uint imageHeight, const vo
 extern void SysDrawText(const char* text);
 extern void SysDrawNumber(const uint number);
 
+extern bool SysSetTileMapImage(const uint imageWidth, const uint imageHeight, const void* dataAddress, const uint tileSize);
+extern bool SysSetTileMap(const uint mapWidth, const uint mapHeight, const byte* tilesAddress, const bool doWrap);
+extern void SysDrawTileMapLines(const ScanlineTransform* lineTransforms, const int firstRow, const uint numberOfRows);
+extern void SysDrawPerspectiveMap(const f16 xPosition, const f16 yPosition, const f16 cameraHeight, const f16 angleDegrees, const int horizonRow, const f16 focalLength);
+
+extern void SysSetLineEffects(const LineEffect* lineEffects, const int firstRow, const uint numberOfRows);
+extern void SysClearLineEffects(void);
+
+extern void SysSetScreenRemap(const byte* remapTable);
+extern void SysSetDrawRemap(const byte* remapTable);
+extern void SysBuildBlendRemap(byte* remapTable, const uint redValue, const uint greenValue, const uint blueValue, const uint blendAmount);
+extern void SysBuildCycleRemap(byte* remapTable, const uint firstColor, const uint numberOfColors, const int cycleOffset);
+
+extern void SysSetDeferredRendering(const bool isEnabled);
+
+extern bool SysBeginStaticLayer(const uint layerIndex);
+extern void SysEndStaticLayer(const uint layerIndex);
+extern void SysInvalidateStaticLayers(void);
+
 static inline void ClearScreen(const uint colorIndex) {
     SysClearScreen(colorIndex);
 }
@@ -198,6 +240,16 @@ static inline void SetDrawScale(const f16 xScale, const f16 yScale) {
     SysSetDrawScale(xScale, yScale);
 }
 
+// Rotated or transformed images turn around their draw anchor, which lands on the draw position.
+
+static inline void SetDrawTransform(const FixedMatrix2D* matrix) {
+    SysSetDrawTransform(matrix->A, matrix->B, matrix->C, matrix->D);
+}
+
+static inline void SetDrawRotation(const f16 angleDegrees) {
+    SysSetDrawRotation(angleDegrees);
+}
+
 static inline void SetTextFont(const Image* image) {
     if (image) {
         SysSetTextFont(image->Width, image->Height, image->Data);
@@ -227,6 +279,80 @@ static inline void DrawNumber(const int xPosition, const int yPosition, const ui
     SysDrawNumber(number);
 }
 
+// Tile maps index square, power of two sized tiles from a tileset image, numbered left to right, top to bottom.
+// Each screen row samples the map along its own line, either from a guest table or from a perspective camera.
+
+static inline bool SetTileMapImage(const Image* image, const uint tileSize) {
+    return SysSetTileMapImage(image->Width, image->Height, image->Data, tileSize);
+}
+
+static inline bool SetTileMap(const byte* tiles, const uint mapWidth, const uint mapHeight, const bool doWrap) {
+    return SysSetTileMap(mapWidth, mapHeight, tiles, doWrap);
+}
+
+static inline void DrawTileMapLines(const ScanlineTransform* lineTransforms, const int firstRow, const uint numberOfRows) {
+    SysDrawTileMapLines(lineTransforms, firstRow, numberOfRows);
+}
+
+static inline void DrawPerspectiveMap(const f16 xPosition, const f16 yPosition, const f16 cameraHeight, const f16 angleDegrees, const int horizonRow, const f16 focalLength) {
+    SysDrawPerspectiveMap(xPosition, yPosition, cameraHeight, angleDegrees, horizonRow, focalLength);
+}
+
+// Line effects stay active until replaced or cleared and are applied while the frame is sent to the display.
+
+static inline void SetLineEffects(const LineEffect* lineEffects, const int firstRow, const uint numberOfRows) {
+    SysSetLineEffects(lineEffects, firstRow, numberOfRows);
+}
+
+static inline void ClearLineEffects(void) {
+    SysClearLineEffects();
+}
+
+// Remap tables hold 256 color indexes. The screen remap changes the displayed palette at no per-pixel cost
+// (fades, flashes, color cycling), the draw remap applies to everything drawn while it is set. NULL restores.
+
+static inline void SetScreenRemap(const byte* remapTable) {
+    SysSetScreenRemap(remapTable);
+}
+
+static inline void SetDrawRemap(const byte* remapTable) {
+    SysSetDrawRemap(remapTable);
+}
+
+static inline void BuildBlendRemap(byte* remapTable, const uint redValue, const uint greenValue, const uint blueValue, const uint blendAmount) {
+    SysBuildBlendRemap(remapTable, redValue, greenValue, blueValue, blendAmount);
+}
+
+static inline void BuildCycleRemap(byte* remapTable, const uint firstColor, const uint numberOfColors, const int cycleOffset) {
+    SysBuildCycleRemap(remapTable, firstColor, numberOfColors, cycleOffset);
+}
+
+// Deferred rendering draws the frame at sync in strips of rows, sending each strip while the next one is
+// drawn. Images drawn during the frame must not change until Sync.
+
+static inline void SetDeferredRendering(const bool isEnabled) {
+    SysSetDeferredRendering(isEnabled);
+}
+
+// Static layers (up to two) skip rasterizing unchanged backgrounds. A layer is drawn every frame between
+// BeginStaticLayer and EndStaticLayer, and when its draws, remaps and the memory they read are the same as
+// the last time, a copy of the frame taken after it is shown instead. Static layers are the first draws of
+// a frame, layer 0 first, since the copy replaces everything under them. BeginStaticLayer returns false when
+// the layer is not cached: the layer breaks that order, or the device has no memory for the copies (the
+// RP2040 handheld has none, static layers are a host-only optimization). The layer is then simply drawn.
+
+static inline bool BeginStaticLayer(const uint layerIndex) {
+    return SysBeginStaticLayer(layerIndex);
+}
+
+static inline void EndStaticLayer(const uint layerIndex) {
+    SysEndStaticLayer(layerIndex);
+}
+
+static inline void InvalidateStaticLayers(void) {
+    SysInvalidateStaticLayers();
+}
+
 // Sound ----------------------------------------------------------------------
 
 #define SoundFrequency 22050
@@ -271,19 +397,48 @@ static inline void StopAllSound(void) {
 
 // Engine ---------------------------------------------------------------------
 
-#define MaxLayers        4
-#define MaxLayerEntities 128
-#define MaxSprites       256
+#define MaxLayers         4
+#define MaxLayerEntities  128
+#define MaxSprites        256
+#define MaxEmitters       16
+#define MaxLayerParticles 128
+
+#define BehaviorBounce           0b00000001
+#define BehaviorWrap             0b00000010
+#define BehaviorReleaseOffscreen 0b00000100
+#define BehaviorContinuous       0b00001000
+
+#define ClipLoop     0
+#define ClipOnce     1
+#define ClipPingPong 2
+
+#define ClipFinishNone    0
+#define ClipFinishSwitch  1
+#define ClipFinishRelease 2
+
+#define LayerSortNone  0
+#define LayerSortY     1
+#define LayerSortDepth 2
+
+#define NavigationIdle      0
+#define NavigationSearching 1
+#define NavigationFound     2
+#define NavigationNotFound  3
 
 extern void SysSyncEngine(void);
+extern void SysSetFixedTimestep(const bool isEnabled);
 
 extern int  SysGetSprite(const uint imageWidth, const uint imageHeight, const void* dataAddress);
 extern void SysReleaseSprite(const uint spriteID);
 extern void SysSetSpriteProps(const uint spriteID, const uint transparentColor, const uint frameWidth, const uint frameHeight);
 extern void SysSetSpriteFrames(const uint spriteID, const uint numberOfFrames, const uint framesPerSecond);
+extern void SysSetSpriteCollisionMask(const uint spriteID, const bool useCollisionMask);
+extern void SysSetSpriteClip(const uint spriteID, const uint clipID, const uint firstFrame, const uint numberOfFrames, const uint framesPerSecond, const uint clipMode);
+extern void SysSetSpriteClipFinish(const uint spriteID, const uint clipID, const uint finishAction, const uint nextClipID);
 
 extern void SysSetActiveLayer(const uint layerIndex);
 extern uint SysGetNumberOfEntities(void);
+extern uint SysGetEntityIndexLimit(void);
 
 extern int  SysGetEntity(const uint typeID, const uint spriteID, const f16 xPosition, const f16 yPosition);
 extern void SysReleaseEntity(const uint entityIndex);
@@ -308,10 +463,58 @@ extern int   SysGetCollidingEntityIndex(const uint entityIndex, const uint other
 extern int SysFindEntityIndex(const uint typeID, const uint occurrenceNumber);
 extern int SysIsEntityOnScreen(const uint entityIndex);
 
+extern void SysSetEntityBehaviors(const uint entityIndex, const uint behaviors);
+extern void SysSetEntityAcceleration(const uint entityIndex, const f16 xAcceleration, const f16 yAcceleration);
+extern void SysSetEntityMaxSpeed(const uint entityIndex, const f16 xMaxSpeed, const f16 yMaxSpeed);
+extern void SysSetEntityFriction(const uint entityIndex, const f16 friction);
+extern void SysSetEntityLifetime(const uint entityIndex, const uint lifetimeMs);
+extern void SysSetEntityCollisionType(const uint entityIndex, const uint otherTypeID);
+extern int  SysGetEntityContactIndex(const uint entityIndex);
+extern f16  SysGetEntityContactTime(const uint entityIndex);
+extern void SysSetEntityParent(const uint entityIndex, const int parentIndex, const f16 xOffset, const f16 yOffset);
+extern int  SysGetEntityParent(const uint entityIndex);
+extern void SysSetEntityClip(const uint entityIndex, const int clipID);
+extern int  SysGetEntityClip(const uint entityIndex);
+extern void SysSetEntityDepth(const uint entityIndex, const int depth);
+
+extern uint SysQueryEntitiesInRect(const uint typeID, const int xPosition, const int yPosition, const uint width, const uint height, int* entityIndexes, const uint maxResults);
+extern uint SysQueryEntitiesInRadius(const uint typeID, const f16 xPosition, const f16 yPosition, const f16 radius, int* entityIndexes, const uint maxResults);
+extern int  SysGetNearestEntityIndex(const uint typeID, const f16 xPosition, const f16 yPosition);
+extern int  SysCastRay(const uint typeID, const f16 xPosition, const f16 yPosition, const f16 xDelta, const f16 yDelta, f16* hitTime);
+
+extern bool SysSetNavigationGrid(const byte* cells, const uint width, const uint height);
+extern void SysSetNavigationBudget(const uint cellsPerSync);
+extern bool SysStartPathSearch(const uint startX, const uint startY, const uint goalX, const uint goalY);
+extern uint SysGetPathStatus(void);
+extern uint SysGetPath(int* cellIndexes, const uint maxCells);
+extern bool SysStartFlowField(const uint targetX, const uint targetY);
+extern uint SysGetFlowFieldStatus(void);
+extern int  SysGetFlowNextCell(const uint xCell, const uint yCell);
+
+extern void SysSetCameraPosition(const f16 xPosition, const f16 yPosition);
+extern void SysSetLayerOffset(const f16 xOffset, const f16 yOffset);
+extern void SysSetLayerParallax(const f16 xFactor, const f16 yFactor);
+extern void SysSetLayerSortMode(const uint sortMode);
+
+extern int  SysGetEmitter(const f16 xPosition, const f16 yPosition);
+extern void SysReleaseEmitter(const uint emitterIndex);
+extern void SysSetEmitterPosition(const uint emitterIndex, const f16 xPosition, const f16 yPosition);
+extern void SysSetEmitterRate(const uint emitterIndex, const uint particlesPerSecond);
+extern void SysSetEmitterLifetime(const uint emitterIndex, const uint lifetimeMs);
+extern void SysSetEmitterVelocity(const uint emitterIndex, const f16 xVelocity, const f16 yVelocity, const f16 xSpread, const f16 ySpread);
+extern void SysSetEmitterGravity(const uint emitterIndex, const f16 xGravity, const f16 yGravity);
+extern void SysSetEmitterColors(const uint emitterIndex, const uint startColor, const uint numberOfColors);
+extern void SysSetEmitterSprite(const uint emitterIndex, const int spriteID);
+extern void SysEmitParticles(const uint emitterIndex, const uint numberOfParticles);
+
 static inline void SyncEngine(void) {
     SysSyncEngine();
 }
 
+static inline void SetFixedTimestep(const bool isEnabled) {
+    SysSetFixedTimestep(isEnabled);
+}
+
 static inline uint GetSprite(const Image* image, const uint transparentColor, const uint frameWidth, const uint frameHeight) {
     uint spriteID = SysGetSprite(image->Width, image->Height, image->Data);
     SysSetSpriteProps(spriteID, transparentColor, frameWidth, frameHeight);
@@ -322,6 +525,18 @@ static inline void ConfigureSprite(const uint spriteID, const uint numberOfFrame
     SysSetSpriteFrames(spriteID, numberOfFrames, framesPerSecond);
 }
 
+static inline void SetSpriteCollisionMask(const uint spriteID, const bool useCollisionMask) {
+    SysSetSpriteCollisionMask(spriteID, useCollisionMask);
+}
+
+static inline void SetSpriteClip(const uint spriteID, const uint clipID, const uint firstFrame, const uint numberOfFrames, const uint framesPerSecond, const uint clipMode) {
+    SysSetSpriteClip(spriteID, clipID, firstFrame, numberOfFrames, framesPerSecond, clipMode);
+}
+
+static inline void SetSpriteClipFinish(const uint spriteID, const uint clipID, const uint finishAction, const uint nextClipID) {
+    SysSetSpriteClipFinish(spriteID, clipID, finishAction, nextClipID);
+}
+
 static inline void ReleaseSprite(const uint spriteID) {
     SysReleaseSprite(spriteID);
 }
@@ -330,10 +545,19 @@ static inline void SetActiveLayer(const uint layerIndex) {
     SysSetActiveLayer(layerIndex);
 }
 
+// Entity indexes returned by the engine are handles: the slot in the low 8 bits and its generation above them,
+// so a handle kept after its entity was released fails instead of reaching whatever reuses the slot. Released
+// slots leave holes, so iterate a layer from 0 to GetEntityIndexLimit (GetNumberOfEntities is only the count)
+// and skip the slots whose type is -1. Plain slot indexes always address the slot's current entity.
+
 static inline uint GetNumberOfEntities(void) {
     return SysGetNumberOfEntities();
 }
 
+static inline uint GetEntityIndexLimit(void) {
+    return SysGetEntityIndexLimit();
+}
+
 static inline uint GetEntity(const uint typeID, const uint spriteID, const f16 xPosition, const f16 yPosition) {
     return SysGetEntity(typeID, spriteID, xPosition, yPosition);
 }
@@ -410,4 +634,163 @@ static inline bool IsEntityOnScreen(const uint entityIndex) {
     return SysIsEntityOnScreen(entityIndex);
 }
 
+static inline void SetEntityBehaviors(const uint entityIndex, const uint behaviors) {
+    SysSetEntityBehaviors(entityIndex, behaviors);
+}
+
+static inline void SetEntityAcceleration(const uint entityIndex, const f16 xAcceleration, const f16 yAcceleration) {
+    SysSetEntityAcceleration(entityIndex, xAcceleration, yAcceleration);
+}
+
+static inline void SetEntityMaxSpeed(const uint entityIndex, const f16 xMaxSpeed, const f16 yMaxSpeed) {
+    SysSetEntityMaxSpeed(entityIndex, xMaxSpeed, yMaxSpeed);
+}
+
+static inline void SetEntityFriction(const uint entityIndex, const f16 friction) {
+    SysSetEntityFriction(entityIndex, friction);
+}
+
+static inline void SetEntityLifetime(const uint entityIndex, const uint lifetimeMs) {
+    SysSetEntityLifetime(entityIndex, lifetimeMs);
+}
+
+static inline void SetEntityCollisionType(const uint entityIndex, const uint otherTypeID) {
+    SysSetEntityCollisionType(entityIndex, otherTypeID);
+}
+
+static inline int GetEntityContactIndex(const uint entityIndex) {
+    return SysGetEntityContactIndex(entityIndex);
+}
+
+static inline f16 GetEntityContactTime(const uint entityIndex) {
+    return SysGetEntityContactTime(entityIndex);
+}
+
+static inline void SetEntityParent(const uint entityIndex, const int parentIndex, const f16 xOffset, const f16 yOffset) {
+    SysSetEntityParent(entityIndex, parentIndex, xOffset, yOffset);
+}
+
+static inline int GetEntityParent(const uint entityIndex) {
+    return SysGetEntityParent(entityIndex);
+}
+
+static inline void SetEntityClip(const uint entityIndex, const int clipID) {
+    SysSetEntityClip(entityIndex, clipID);
+}
+
+static inline int GetEntityClip(const uint entityIndex) {
+    return SysGetEntityClip(entityIndex);
+}
+
+static inline void SetEntityDepth(const uint entityIndex, const int depth) {
+    SysSetEntityDepth(entityIndex, depth);
+}
+
+static inline uint QueryEntitiesInRect(const uint typeID, const int xPosition, const int yPosition, const uint width, const uint height, int* entityIndexes, const uint maxResults) {
+    return SysQueryEntitiesInRect(typeID, xPosition, yPosition, width, height, entityIndexes, maxResults);
+}
+
+static inline uint QueryEntitiesInRadius(const uint typeID, const f16 xPosition, const f16 yPosition, const f16 radius, int* entityIndexes, const uint maxResults) {
+    return SysQueryEntitiesInRadius(typeID, xPosition, yPosition, radius, entityIndexes, maxResults);
+}
+
+static inline int GetNearestEntityIndex(const uint typeID, const f16 xPosition, const f16 yPosition) {
+    return SysGetNearestEntityIndex(typeID, xPosition, yPosition);
+}
+
+static inline int CastRay(const uint typeID, const f16 xPosition, const f16 yPosition, const f16 xDelta, const f16 yDelta, f16* hitTime) {
+    return SysCastRay(typeID, xPosition, yPosition, xDelta, yDelta, hitTime);
+}
+
+// Grids larger than the device's search buffers are rejected: 1024 cells on the desktop, 320 on the RP2040
+// (enough for a screen of 8x8 tiles).
+
+static inline bool SetNavigationGrid(const byte* cells, const uint width, const uint height) {
+    return SysSetNavigationGrid(cells, width, height);
+}
+
+static inline void SetNavigationBudget(const uint cellsPerSync) {
+    SysSetNavigationBudget(cellsPerSync);
+}
+
+static inline bool StartPathSearch(const uint startX, const uint startY, const uint goalX, const uint goalY) {
+    return SysStartPathSearch(startX, startY, goalX, goalY);
+}
+
+static inline uint GetPathStatus(void) {
+    return SysGetPathStatus();
+}
+
+static inline uint GetPath(int* cellIndexes, const uint maxCells) {
+    return SysGetPath(cellIndexes, maxCells);
+}
+
+static inline bool StartFlowField(const uint targetX, const uint targetY) {
+    return SysStartFlowField(targetX, targetY);
+}
+
+static inline uint GetFlowFieldStatus(void) {
+    return SysGetFlowFieldStatus();
+}
+
+static inline int GetFlowNextCell(const uint xCell, const uint yCell) {
+    return SysGetFlowNextCell(xCell, yCell);
+}
+
+static inline void SetCameraPosition(const f16 xPosition, const f16 yPosition) {
+    SysSetCameraPosition(xPosition, yPosition);
+}
+
+static inline void SetLayerOffset(const f16 xOffset, const f16 yOffset) {
+    SysSetLayerOffset(xOffset, yOffset);
+}
+
+static inline void SetLayerParallax(const f16 xFactor, const f16 yFactor) {
+    SysSetLayerParallax(xFactor, yFactor);
+}
+
+static inline void SetLayerSortMode(const uint sortMode) {
+    SysSetLayerSortMode(sortMode);
+}
+
+static inline int GetEmitter(const f16 xPosition, const f16 yPosition) {
+    return SysGetEmitter(xPosition, yPosition);
+}
+
+static inline void ReleaseEmitter(const uint emitterIndex) {
+    SysReleaseEmitter(emitterIndex);
+}
+
+static inline void SetEmitterPosition(const uint emitterIndex, const f16 xPosition, const f16 yPosition) {
+    SysSetEmitterPosition(emitterIndex, xPosition, yPosition);
+}
+
+static inline void SetEmitterRate(const uint emitterIndex, const uint particlesPerSecond) {
+    SysSetEmitterRate(emitterIndex, particlesPerSecond);
+}
+
+static inline void SetEmitterLifetime(const uint emitterIndex, const uint lifetimeMs) {
+    SysSetEmitterLifetime(emitterIndex, lifetimeMs);
+}
+
+static inline void SetEmitterVelocity(const uint emitterIndex, const f16 xVelocity, const f16 yVelocity, const f16 xSpread, const f16 ySpread) {
+    SysSetEmitterVelocity(emitterIndex, xVelocity, yVelocity, xSpread, ySpread);
+}
+
+static inline void SetEmitterGravity(const uint emitterIndex, const f16 xGravity, const f16 yGravity) {
+    SysSetEmitterGravity(emitterIndex, xGravity, yGravity);
+}
+
+static inline void SetEmitterColors(const uint emitterIndex, const uint startColor, const uint numberOfColors) {
+    SysSetEmitterColors(emitterIndex, startColor, numberOfColors);
+}
+
+static inline void SetEmitterSprite(const uint emitterIndex, const int spriteID) {
+    SysSetEmitterSprite(emitterIndex, spriteID);
+}
+
+static inline void EmitParticles(const uint emitterIndex, const uint numberOfParticles) {
+    SysEmitParticles(emitterIndex, numberOfParticles);
+}
+
 #endif    // PORTATIL_SDK_H
\ No newline at end of file
@@ -313,6 +313,54 @@ SysGetNumberOfEntities:
     ecall
     ret
 
+.globl	SysGetEntityIndexLimit
+.type	SysGetEntityIndexLimit, @function
+
+SysGetEntityIndexLimit:
+    add a7, zero, 113
+    ecall
+    ret
+
+.globl	SysSetEntityParent
+.type	SysSetEntityParent, @function
+
+SysSetEntityParent:
+    add a7, zero, 114
+    ecall
+    ret
+
+.globl	SysGetEntityParent
+.type	SysGetEntityParent, @function
+
+SysGetEntityParent:
+    add a7, zero, 115
+    ecall
+    ret
+
+.globl	SysSetEntityClip
+.type	SysSetEntityClip, @function
+
+SysSetEntityClip:
+    add a7, zero, 118
+    ecall
+    ret
+
+.globl	SysGetEntityClip
+.type	SysGetEntityClip, @function
+
+SysGetEntityClip:
+    add a7, zero, 119
+    ecall
+    ret
+
+.globl	SysSetEntityDepth
+.type	SysSetEntityDepth, @function
+
+SysSetEntityDepth:
+    add a7, zero, 121
+    ecall
+    ret
+
 .globl	SysGetEntity
 .type	SysGetEntity, @function
 
@@ -468,3 +516,435 @@ SysIsEntityOnScreen:
     add a7, zero, 85
     ecall
     ret
+
+.globl	SysSetCameraPosition
+.type	SysSetCameraPosition, @function
+
+SysSetCameraPosition:
+    add a7, zero, 86
+    ecall
+    ret
+
+.globl	SysSetLayerOffset
+.type	SysSetLayerOffset, @function
+
+SysSetLayerOffset:
+    add a7, zero, 87
+    ecall
+    ret
+
+.globl	SysSetLayerParallax
+.type	SysSetLayerParallax, @function
+
+SysSetLayerParallax:
+    add a7, zero, 88
+    ecall
+    ret
+
+.globl	SysSetLayerSortMode
+.type	SysSetLayerSortMode, @function
+
+SysSetLayerSortMode:
+    add a7, zero, 120
+    ecall
+    ret
+
+.globl	SysGetEmitter
+.type	SysGetEmitter, @function
+
+SysGetEmitter:
+    add a7, zero, 89
+    ecall
+    ret
+
+.globl	SysReleaseEmitter
+.type	SysReleaseEmitter, @function
+
+SysReleaseEmitter:
+    add a7, zero, 90
+    ecall
+    ret
+
+.globl	SysSetEmitterPosition
+.type	SysSetEmitterPosition, @function
+
+SysSetEmitterPosition:
+    add a7, zero, 91
+    ecall
+    ret
+
+.globl	SysSetEmitterRate
+.type	SysSetEmitterRate, @function
+
+SysSetEmitterRate:
+    add a7, zero, 92
+    ecall
+    ret
+
+.globl	SysSetEmitterLifetime
+.type	SysSetEmitterLifetime, @function
+
+SysSetEmitterLifetime:
+    add a7, zero, 93
+    ecall
+    ret
+
+.globl	SysSetEmitterVelocity
+.type	SysSetEmitterVelocity, @function
+
+SysSetEmitterVelocity:
+    add a7, zero, 94
+    ecall
+    ret
+
+.globl	SysSetEmitterGravity
+.type	SysSetEmitterGravity, @function
+
+SysSetEmitterGravity:
+    add a7, zero, 95
+    ecall
+    ret
+
+.globl	SysSetEmitterColors
+.type	SysSetEmitterColors, @function
+
+SysSetEmitterColors:
+    add a7, zero, 96
+    ecall
+    ret
+
+.globl	SysSetEmitterSprite
+.type	SysSetEmitterSprite, @function
+
+SysSetEmitterSprite:
+    add a7, zero, 97
+    ecall
+    ret
+
+.globl	SysEmitParticles
+.type	SysEmitParticles, @function
+
+SysEmitParticles:
+    add a7, zero, 98
+    ecall
+    ret
+
+.globl	SysSetEntityBehaviors
+.type	SysSetEntityBehaviors, @function
+
+SysSetEntityBehaviors:
+    add a7, zero, 99
+    ecall
+    ret
+
+.globl	SysSetEntityAcceleration
+.type	SysSetEntityAcceleration, @function
+
+SysSetEntityAcceleration:
+    add a7, zero, 100
+    ecall
+    ret
+
+.globl	SysSetEntityMaxSpeed
+.type	SysSetEntityMaxSpeed, @function
+
+SysSetEntityMaxSpeed:
+    add a7, zero, 101
+    ecall
+    ret
+
+.globl	SysSetEntityFriction
+.type	SysSetEntityFriction, @function
+
+SysSetEntityFriction:
+    add a7, zero, 102
+    ecall
+    ret
+
+.globl	SysSetEntityLifetime
+.type	SysSetEntityLifetime, @function
+
+SysSetEntityLifetime:
+    add a7, zero, 103
+    ecall
+    ret
+
+.globl	SysSetEntityCollisionType
+.type	SysSetEntityCollisionType, @function
+
+SysSetEntityCollisionType:
+    add a7, zero, 104
+    ecall
+    ret
+
+.globl	SysGetEntityContactIndex
+.type	SysGetEntityContactIndex, @function
+
+SysGetEntityContactIndex:
+    add a7, zero, 105
+    ecall
+    ret
+
+.globl	SysGetEntityContactTime
+.type	SysGetEntityContactTime, @function
+
+SysGetEntityContactTime:
+    add a7, zero, 106
+    ecall
+    ret
+
+.globl	SysSetSpriteCollisionMask
+.type	SysSetSpriteCollisionMask, @function
+
+SysSetSpriteCollisionMask:
+    add a7, zero, 107
+    ecall
+    ret
+
+.globl	SysSetSpriteClip
+.type	SysSetSpriteClip, @function
+
+SysSetSpriteClip:
+    add a7, zero, 116
+    ecall
+    ret
+
+.globl	SysSetSpriteClipFinish
+.type	SysSetSpriteClipFinish, @function
+
+SysSetSpriteClipFinish:
+    add a7, zero, 117
+    ecall
+    ret
+
+.globl	SysQueryEntitiesInRect
+.type	SysQueryEntitiesInRect, @function
+
+SysQueryEntitiesInRect:
+    add a7, zero, 108
+    ecall
+    ret
+
+.globl	SysQueryEntitiesInRadius
+.type	SysQueryEntitiesInRadius, @function
+
+SysQueryEntitiesInRadius:
+    add a7, zero, 109
+    ecall
+    ret
+
+.globl	SysGetNearestEntityIndex
+.type	SysGetNearestEntityIndex, @function
+
+SysGetNearestEntityIndex:
+    add a7, zero, 110
+    ecall
+    ret
+
+.globl	SysCastRay
+.type	SysCastRay, @function
+
+SysCastRay:
+    add a7, zero, 111
+    ecall
+    ret
+
+.globl	SysSetNavigationGrid
+.type	SysSetNavigationGrid, @function
+
+SysSetNavigationGrid:
+    add a7, zero, 122
+    ecall
+    ret
+
+.globl	SysSetNavigationBudget
+.type	SysSetNavigationBudget, @function
+
+SysSetNavigationBudget:
+    add a7, zero, 123
+    ecall
+    ret
+
+.globl	SysStartPathSearch
+.type	SysStartPathSearch, @function
+
+SysStartPathSearch:
+    add a7, zero, 124
+    ecall
+    ret
+
+.globl	SysGetPathStatus
+.type	SysGetPathStatus, @function
+
+SysGetPathStatus:
+    add a7, zero, 125
+    ecall
+    ret
+
+.globl	SysGetPath
+.type	SysGetPath, @function
+
+SysGetPath:
+    add a7, zero, 126
+    ecall
+    ret
+
+.globl	SysStartFlowField
+.type	SysStartFlowField, @function
+
+SysStartFlowField:
+    add a7, zero, 127
+    ecall
+    ret
+
+.globl	SysGetFlowFieldStatus
+.type	SysGetFlowFieldStatus, @function
+
+SysGetFlowFieldStatus:
+    add a7, zero, 128
+    ecall
+    ret
+
+.globl	SysGetFlowNextCell
+.type	SysGetFlowNextCell, @function
+
+SysGetFlowNextCell:
+    add a7, zero, 129
+    ecall
+    ret
+
+.globl	SysSetDrawTransform
+.type	SysSetDrawTransform, @function
+
+SysSetDrawTransform:
+    add a7, zero, 130
+    ecall
+    ret
+
+.globl	SysSetDrawRotation
+.type	SysSetDrawRotation, @function
+
+SysSetDrawRotation:
+    add a7, zero, 131
+    ecall
+    ret
+
+.globl	SysSetTileMapImage
+.type	SysSetTileMapImage, @function
+
+SysSetTileMapImage:
+    add a7, zero, 132
+    ecall
+    ret
+
+.globl	SysSetTileMap
+.type	SysSetTileMap, @function
+
+SysSetTileMap:
+    add a7, zero, 133
+    ecall
+    ret
+
+.globl	SysDrawTileMapLines
+.type	SysDrawTileMapLines, @function
+
+SysDrawTileMapLines:
+    add a7, zero, 134
+    ecall
+    ret
+
+.globl	SysDrawPerspectiveMap
+.type	SysDrawPerspectiveMap, @function
+
+SysDrawPerspectiveMap:
+    add a7, zero, 135
+    ecall
+    ret
+
+.globl	SysSetLineEffects
+.type	SysSetLineEffects, @function
+
+SysSetLineEffects:
+    add a7, zero, 136
+    ecall
+    ret
+
+.globl	SysClearLineEffects
+.type	SysClearLineEffects, @function
+
+SysClearLineEffects:
+    add a7, zero, 137
+    ecall
+    ret
+
+.globl	SysSetScreenRemap
+.type	SysSetScreenRemap, @function
+
+SysSetScreenRemap:
+    add a7, zero, 138
+    ecall
+    ret
+
+.globl	SysSetDrawRemap
+.type	SysSetDrawRemap, @function
+
+SysSetDrawRemap:
+    add a7, zero, 139
+    ecall
+    ret
+
+.globl	SysBuildBlendRemap
+.type	SysBuildBlendRemap, @function
+
+SysBuildBlendRemap:
+    add a7, zero, 140
+    ecall
+    ret
+
+.globl	SysBuildCycleRemap
+.type	SysBuildCycleRemap, @function
+
+SysBuildCycleRemap:
+    add a7, zero, 141
+    ecall
+    ret
+
+.globl	SysSetDeferredRendering
+.type	SysSetDeferredRendering, @function
+
+SysSetDeferredRendering:
+    add a7, zero, 142
+    ecall
+    ret
+
+.globl	SysBeginStaticLayer
+.type	SysBeginStaticLayer, @function
+
+SysBeginStaticLayer:
+    add a7, zero, 143
+    ecall
+    ret
+
+.globl	SysEndStaticLayer
+.type	SysEndStaticLayer, @function
+
+SysEndStaticLayer:
+    add a7, zero, 144
+    ecall
+    ret
+
+.globl	SysInvalidateStaticLayers
+.type	SysInvalidateStaticLayers, @function
+
+SysInvalidateStaticLayers:
+    add a7, zero, 145
+    ecall
+    ret
+
+.globl	SysSetFixedTimestep
+.type	SysSetFixedTimestep, @function
+
+SysSetFixedTimestep:
+    add a7, zero, 112
+    ecall
+    ret
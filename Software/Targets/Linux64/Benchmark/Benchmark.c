@@ -0,0 +1,81 @@
+//
+// Targets/Linux64/Benchmark/Benchmark.c
+//
+// This file is part of Portatil source code.
+// Copyright 2025 Patrick L. Melo <patrick@patrickmelo.com.br>
+//
+
+#include "Benchmark.h"
+
+// Display --------------------------------------------------------------------
+
+// Nothing is shown, the GPU framebuffer is only kept so the kernels can be checked against each other.
+
+const u8* BenchmarkFramebuffer = NULL;
+
+static u8 shownFrame[ScreenPixels];
+
+bool DrvDisplayInitialize(void) {
+    return true;
+}
+
+void DrvDisplayFinalize(void) {
+    // Empty
+}
+
+void DrvDisplaySetColorPallete(const u8* colorPalette) {
+    // Empty
+}
+
+u64 DrvDisplaySync(const u8* framebufferData, const LineEffect* lineEffects) {
+    BenchmarkFramebuffer = framebufferData;
+    memcpy(shownFrame, framebufferData, ScreenPixels);
+    return 0;
+}
+
+u64 DrvDisplaySyncLines(const u8* framebufferData, const u32 firstRow, const u32 numberOfRows) {
+    BenchmarkFramebuffer = framebufferData;
+    memcpy(&shownFrame[firstRow * ScreenWidth], &framebufferData[firstRow * ScreenWidth], numberOfRows * ScreenWidth);
+    return 0;
+}
+
+u64 DrvDisplaySyncRegions(const u8* framebufferData, const Rectangle2D* regions, const u32 numberOfRegions) {
+    BenchmarkFramebuffer = framebufferData;
+
+    for (u32 regionIndex = 0; regionIndex < numberOfRegions; regionIndex++) {
+        memcpy(&shownFrame[regions[regionIndex].Y * ScreenWidth], &framebufferData[regions[regionIndex].Y * ScreenWidth], regions[regionIndex].Height * ScreenWidth);
+    }
+
+    return 0;
+}
+
+const u8* DrvDisplayGetFrame(void) {
+    return shownFrame;
+}
+
+u64 DrvDisplayGetTime(void) {
+    return 0;
+}
+
+// Kernel ---------------------------------------------------------------------
+
+// The CPU driver shuts the kernel down on signals, which here only has to exit.
+
+void Shutdown(void) {
+    DrvCpuFinalize();
+    exit(1);
+}
+
+// Main -----------------------------------------------------------------------
+
+int main(const int numberOfArguments, const string* argumentsValues) {
+    if (!DrvCpuInitialize() || !DrvGpuInitialize()) {
+        return 1;
+    }
+
+    bool hasPassed = RunGpuBenchmark();
+
+    DrvGpuFinalize();
+    DrvCpuFinalize();
+    return hasPassed ? 0 : 1;
+}
\ No newline at end of file
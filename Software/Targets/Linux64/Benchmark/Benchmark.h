@@ -0,0 +1,20 @@
+//
+// Targets/Linux64/Benchmark/Benchmark.h
+//
+// This file is part of Portatil source code.
+// Copyright 2025 Patrick L. Melo <patrick@patrickmelo.com.br>
+//
+
+#pragma once
+
+#include "Drivers.h"
+
+#include <stdio.h>
+
+// Benchmark ------------------------------------------------------------------
+
+#define BenchmarkRunTime 250000    // Microseconds each case is repeated for.
+
+extern const u8* BenchmarkFramebuffer;
+
+bool RunGpuBenchmark(void);
\ No newline at end of file
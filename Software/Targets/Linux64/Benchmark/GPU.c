@@ -0,0 +1,456 @@
+//
+// Targets/Linux64/Benchmark/GPU.c
+//
+// This file is part of Portatil source code.
+// Copyright 2025 Patrick L. Melo <patrick@patrickmelo.com.br>
+//
+
+#include "Benchmark.h"
+
+// Legacy ---------------------------------------------------------------------
+
+// The per-pixel kernels the generic GPU driver used before its row kernels, kept as the reference the
+// current ones are measured and checked against. They keep the driver's busy time accounting, so both
+// sides pay for the same timer reads.
+
+#define startTimer() u64 startTime = DrvCpuGetTick()
+#define stopTimer()  legacyBusyTime += DrvCpuGetTick() - startTime
+
+static u8  legacyFramebuffer[ScreenPixels];
+static u16 legacyTransparentColor = ColorNone;
+static u16 legacyBackgroundColor  = ColorNone;
+static u16 legacyForegroundColor  = ColorNone;
+static u64 legacyBusyTime         = 0;
+
+static void legacyClear(const u8 colorIndex) {
+    startTimer();
+
+    for (uint pixelIndex = 0; pixelIndex < ScreenPixels; pixelIndex++) {
+        legacyFramebuffer[pixelIndex] = colorIndex;
+    }
+
+    stopTimer();
+}
+
+static void legacyDraw(const Image* image, const Point2D* position, const Rectangle2D* clipRect) {
+    Rectangle2D offsetTargetRect = {
+        .X      = position->X,
+        .Y      = position->Y,
+        .Width  = clipRect->Width,
+        .Height = clipRect->Height,
+    };
+
+    Rectangle2D offsetClipRect = *clipRect;
+
+    if ((offsetTargetRect.X > ScreenWidth) || (offsetTargetRect.Y > ScreenHeight) ||
+        (offsetTargetRect.X + offsetTargetRect.Width < 0) || (offsetTargetRect.Y + offsetTargetRect.Height < 0)) {
+        return;
+    }
+
+    startTimer();
+
+    if (offsetTargetRect.X < 0) {
+        offsetClipRect.X -= offsetTargetRect.X;
+        offsetClipRect.Width += offsetTargetRect.X;
+
+        offsetTargetRect.Width += offsetTargetRect.X;
+        offsetTargetRect.X = 0;
+    }
+
+    if (offsetTargetRect.X + offsetTargetRect.Width > ScreenWidth) {
+        offsetTargetRect.Width -= (offsetTargetRect.X + offsetTargetRect.Width) - ScreenWidth;
+        offsetClipRect.Width = offsetTargetRect.Width;
+    }
+
+    if (offsetTargetRect.Y < 0) {
+        offsetClipRect.Y -= offsetTargetRect.Y;
+        offsetClipRect.Height += offsetTargetRect.Y;
+
+        offsetTargetRect.Height += offsetTargetRect.Y;
+        offsetTargetRect.Y = 0;
+    }
+
+    if (offsetTargetRect.Y + offsetTargetRect.Height > ScreenHeight) {
+        offsetTargetRect.Height -= (offsetTargetRect.Y + offsetTargetRect.Height) - ScreenHeight;
+        offsetClipRect.Height = offsetTargetRect.Height;
+    }
+
+    static u32 sourcePixelIndex, targetPixelIndex;
+    static u8  pixelColor;
+
+    for (u16 pixelY = 0; pixelY < offsetTargetRect.Height; pixelY++) {
+        for (u16 pixelX = 0; pixelX < offsetTargetRect.Width; pixelX++) {
+            sourcePixelIndex = ((offsetClipRect.Y + pixelY) * image->Width) + (offsetClipRect.X + pixelX);
+            pixelColor       = image->Data[sourcePixelIndex];
+
+            if (pixelColor == legacyTransparentColor) {
+                if (legacyBackgroundColor == ColorNone) {
+                    continue;
+                }
+
+                pixelColor = legacyBackgroundColor;
+            } else if (legacyForegroundColor != ColorNone) {
+                pixelColor = legacyForegroundColor;
+            }
+
+            targetPixelIndex                    = ((offsetTargetRect.Y + pixelY) * ScreenWidth) + (offsetTargetRect.X + pixelX);
+            legacyFramebuffer[targetPixelIndex] = pixelColor;
+        }
+    }
+
+    stopTimer();
+}
+
+static void legacyDrawScaled(const Image* image, const Rectangle2D* sourceRect, const Rectangle2D* targetRect) {
+    Rectangle2D offsetSourceRect = *sourceRect;
+    Rectangle2D offsetTargetRect = *targetRect;
+
+    if ((offsetTargetRect.X > ScreenWidth) || (offsetTargetRect.Y > ScreenHeight) ||
+        (offsetTargetRect.X + offsetTargetRect.Width < 0) || (offsetTargetRect.Y + offsetTargetRect.Height < 0)) {
+        return;
+    }
+
+    startTimer();
+
+    static i16 offsetDifference;
+
+    f16 sourcePixelWidth  = F16Div(F16(sourceRect->Width), F16(targetRect->Width));
+    f16 sourcePixelHeight = F16Div(F16(sourceRect->Height), F16(targetRect->Height));
+
+    if (offsetTargetRect.X < 0) {
+        offsetDifference = F16ToInt(F16Mult(F16(offsetTargetRect.X), sourcePixelWidth));
+        offsetSourceRect.X -= offsetDifference;
+        offsetSourceRect.Width += offsetDifference;
+
+        offsetTargetRect.Width += offsetTargetRect.X;
+        offsetTargetRect.X = 0;
+    }
+
+    if (offsetTargetRect.X + offsetTargetRect.Width > ScreenWidth) {
+        offsetTargetRect.Width -= (offsetTargetRect.X + offsetTargetRect.Width) - ScreenWidth;
+        offsetSourceRect.Width = F16ToInt(F16Mult(F16(offsetTargetRect.Width), sourcePixelWidth));
+    }
+
+    if (offsetTargetRect.Y < 0) {
+        offsetDifference = F16ToInt(F16Mult(F16(offsetTargetRect.Y), sourcePixelHeight));
+        offsetSourceRect.Y -= offsetDifference;
+        offsetSourceRect.Height += offsetDifference;
+
+        offsetTargetRect.Height += offsetTargetRect.Y;
+        offsetTargetRect.Y = 0;
+    }
+
+    if (offsetTargetRect.Y + offsetTargetRect.Height > ScreenHeight) {
+        offsetTargetRect.Height -= (offsetTargetRect.Y + offsetTargetRect.Height) - ScreenHeight;
+        offsetSourceRect.Height = F16ToInt(F16Mult(F16(offsetTargetRect.Height), sourcePixelHeight));
+    }
+
+    static u16 sourcePixelX, sourcePixelY;
+    static u32 sourcePixelIndex, targetPixelIndex;
+    static u8  pixelColor;
+
+    for (u16 pixelY = 0; pixelY < offsetTargetRect.Height; pixelY++) {
+        for (u16 pixelX = 0; pixelX < offsetTargetRect.Width; pixelX++) {
+            sourcePixelX = offsetSourceRect.X + F16ToInt(F16Mult(F16(pixelX), sourcePixelWidth));
+            sourcePixelY = offsetSourceRect.Y + F16ToInt(F16Mult(F16(pixelY), sourcePixelHeight));
+
+            sourcePixelIndex = (sourcePixelY * image->Width) + sourcePixelX;
+            pixelColor       = image->Data[sourcePixelIndex];
+
+            if (pixelColor == legacyTransparentColor) {
+                if (legacyBackgroundColor == ColorNone) {
+                    continue;
+                }
+
+                pixelColor = legacyBackgroundColor;
+            } else if (legacyForegroundColor != ColorNone) {
+                pixelColor = legacyForegroundColor;
+            }
+
+            targetPixelIndex                    = ((offsetTargetRect.Y + pixelY) * ScreenWidth) + (offsetTargetRect.X + pixelX);
+            legacyFramebuffer[targetPixelIndex] = pixelColor;
+        }
+    }
+
+    stopTimer();
+}
+
+static void legacyDrawRectangle(const Rectangle2D* rectangle, const u8 colorIndex) {
+    Rectangle2D offsetRectangle = *rectangle;
+
+    if ((offsetRectangle.X > ScreenWidth) || (offsetRectangle.Y > ScreenHeight) ||
+        (offsetRectangle.X + offsetRectangle.Width < 0) || (offsetRectangle.Y + offsetRectangle.Height < 0)) {
+        return;
+    }
+
+    startTimer();
+
+    if (offsetRectangle.X < 0) {
+        offsetRectangle.Width += offsetRectangle.X;
+        offsetRectangle.X = 0;
+    }
+
+    if (offsetRectangle.X + offsetRectangle.Width > ScreenWidth) {
+        offsetRectangle.Width -= (offsetRectangle.X + offsetRectangle.Width) - ScreenWidth;
+    }
+
+    if (offsetRectangle.Y < 0) {
+        offsetRectangle.Height += offsetRectangle.Y;
+        offsetRectangle.Y = 0;
+    }
+
+    if (offsetRectangle.Y + offsetRectangle.Height > ScreenHeight) {
+        offsetRectangle.Height -= (offsetRectangle.Y + offsetRectangle.Height) - ScreenHeight;
+    }
+
+    static u32 pixelIndex;
+
+    for (u16 pixelY = 0; pixelY < offsetRectangle.Height; pixelY++) {
+        for (u16 pixelX = 0; pixelX < offsetRectangle.Width; pixelX++) {
+            pixelIndex                    = ((offsetRectangle.Y + pixelY) * ScreenWidth) + (offsetRectangle.X + pixelX);
+            legacyFramebuffer[pixelIndex] = colorIndex;
+        }
+    }
+
+    stopTimer();
+}
+
+static void legacyDrawFrame(const Image* image, const Rectangle2D* frameRect, const Point2D* position, const u16 frameTransparentColor) {
+    i32 sourceX     = frameRect->X;
+    i32 sourceY     = frameRect->Y;
+    i32 targetX     = position->X;
+    i32 targetY     = position->Y;
+    i32 frameWidth  = frameRect->Width;
+    i32 frameHeight = frameRect->Height;
+
+    if (targetX < 0) {
+        sourceX -= targetX;
+        frameWidth += targetX;
+        targetX = 0;
+    }
+
+    if (targetY < 0) {
+        sourceY -= targetY;
+        frameHeight += targetY;
+        targetY = 0;
+    }
+
+    if (targetX + frameWidth > ScreenWidth) {
+        frameWidth = ScreenWidth - targetX;
+    }
+
+    if (targetY + frameHeight > ScreenHeight) {
+        frameHeight = ScreenHeight - targetY;
+    }
+
+    if (frameWidth <= 0 || frameHeight <= 0) {
+        return;
+    }
+
+    startTimer();
+
+    const u8* sourceRow = &image->Data[(sourceY * image->Width) + sourceX];
+    u8*       targetRow = &legacyFramebuffer[(targetY * ScreenWidth) + targetX];
+
+    for (i32 pixelY = 0; pixelY < frameHeight; pixelY++) {
+        for (i32 pixelX = 0; pixelX < frameWidth; pixelX++) {
+            if (sourceRow[pixelX] != frameTransparentColor) {
+                targetRow[pixelX] = sourceRow[pixelX];
+            }
+        }
+
+        sourceRow += image->Width;
+        targetRow += ScreenWidth;
+    }
+
+    stopTimer();
+}
+
+// Cases ----------------------------------------------------------------------
+
+#define spriteSize 64
+#define frameSize  32
+
+static u8 backgroundPixels[ScreenPixels];
+static u8 spritePixels[spriteSize * spriteSize];
+
+static const Image backgroundImage = {ScreenWidth, ScreenHeight, backgroundPixels};
+static const Image spriteImage     = {spriteSize, spriteSize, spritePixels};
+
+static const Point2D     spritePosition  = {48, 28};
+static const Point2D     framePosition   = {64, 44};
+static const Rectangle2D backgroundClip  = {0, 0, ScreenWidth, ScreenHeight};
+static const Rectangle2D spriteClip      = {0, 0, spriteSize, spriteSize};
+static const Rectangle2D frameClip       = {16, 16, frameSize, frameSize};
+static const Rectangle2D scaledSource    = {0, 8, spriteSize, spriteSize - 16};
+static const Rectangle2D scaledTarget    = {16, 12, spriteSize * 2, (spriteSize - 16) * 2};
+static const Rectangle2D filledRectangle = {10, 10, ScreenWidth - 20, ScreenHeight - 20};
+
+typedef enum GpuCase {
+    CaseClear,
+    CaseRectangle,
+    CaseDrawOpaque,
+    CaseDrawKeyed,
+    CaseFrameKeyed,
+    CaseScaledKeyed,
+    NumberOfGpuCases,
+} GpuCase;
+
+static const string caseNames[NumberOfGpuCases] = {
+    "Clear", "Rectangle", "Draw opaque", "Draw keyed", "Frame keyed", "Scaled keyed",
+};
+
+static const u32 casePixels[NumberOfGpuCases] = {
+    ScreenPixels,
+    (ScreenWidth - 20) * (ScreenHeight - 20),
+    ScreenPixels,
+    spriteSize * spriteSize,
+    frameSize * frameSize,
+    (spriteSize * 2) * ((spriteSize - 16) * 2),
+};
+
+static void buildImages(void) {
+    srand(1);
+
+    for (u32 pixelIndex = 0; pixelIndex < ScreenPixels; pixelIndex++) {
+        backgroundPixels[pixelIndex] = 1 + rand() % (ScreenColors - 1);
+    }
+
+    // Sprites get a transparent border and transparent holes, like most of the art the runtime draws.
+
+    for (u32 pixelY = 0; pixelY < spriteSize; pixelY++) {
+        for (u32 pixelX = 0; pixelX < spriteSize; pixelX++) {
+            bool isBorder = pixelX < 8 || pixelY < 8 || pixelX >= spriteSize - 8 || pixelY >= spriteSize - 8;
+            bool isHole   = rand() % 8 == 0;
+
+            spritePixels[(pixelY * spriteSize) + pixelX] = (isBorder || isHole) ? 0 : 1 + rand() % (ScreenColors - 1);
+        }
+    }
+}
+
+// Cases are never inlined into the measuring loop, so repeated draws cannot be merged into one.
+
+__attribute__((noinline)) static void runLegacyCase(const GpuCase gpuCase) {
+    switch (gpuCase) {
+        case CaseClear:
+            legacyClear(3);
+            break;
+        case CaseRectangle:
+            legacyDrawRectangle(&filledRectangle, 5);
+            break;
+        case CaseDrawOpaque:
+            legacyTransparentColor = ColorNone;
+            legacyDraw(&backgroundImage, &(Point2D) {0, 0}, &backgroundClip);
+            break;
+        case CaseDrawKeyed:
+            legacyTransparentColor = 0;
+            legacyDraw(&spriteImage, &spritePosition, &spriteClip);
+            break;
+        case CaseFrameKeyed:
+            legacyDrawFrame(&spriteImage, &frameClip, &framePosition, 0);
+            break;
+        case CaseScaledKeyed:
+            legacyTransparentColor = 0;
+            legacyDrawScaled(&spriteImage, &scaledSource, &scaledTarget);
+            break;
+        default:
+            break;
+    }
+}
+
+__attribute__((noinline)) static void runCurrentCase(const GpuCase gpuCase) {
+    switch (gpuCase) {
+        case CaseClear:
+            DrvGpuClear(3);
+            break;
+        case CaseRectangle:
+            DrvGpuDrawRectangle(&filledRectangle, 5);
+            break;
+        case CaseDrawOpaque:
+            DrvGpuSetTransparentColor(ColorNone);
+            DrvGpuDraw(&backgroundImage, &(Point2D) {0, 0}, &backgroundClip);
+            break;
+        case CaseDrawKeyed:
+            DrvGpuSetTransparentColor(0);
+            DrvGpuDraw(&spriteImage, &spritePosition, &spriteClip);
+            break;
+        case CaseFrameKeyed:
+            DrvGpuDrawFrame(&spriteImage, &frameClip, &framePosition, 0);
+            break;
+        case CaseScaledKeyed:
+            DrvGpuSetTransparentColor(0);
+            DrvGpuDrawScaled(&spriteImage, &scaledSource, &scaledTarget);
+            break;
+        default:
+            break;
+    }
+}
+
+// Both framebuffers start from the background so keyed kernels have something to keep.
+
+static bool isCaseMatching(const GpuCase gpuCase) {
+    legacyTransparentColor = ColorNone;
+    legacyDraw(&backgroundImage, &(Point2D) {0, 0}, &backgroundClip);
+    runLegacyCase(gpuCase);
+
+    DrvGpuSetTransparentColor(ColorNone);
+    DrvGpuDraw(&backgroundImage, &(Point2D) {0, 0}, &backgroundClip);
+    runCurrentCase(gpuCase);
+    DrvGpuSync();
+
+    return BenchmarkFramebuffer && memcmp(BenchmarkFramebuffer, legacyFramebuffer, ScreenPixels) == 0;
+}
+
+static float measureCase(const GpuCase gpuCase, const bool isLegacy) {
+    u64 startTime     = DrvCpuGetTick();
+    u64 elapsedTime   = 0;
+    u64 numberOfCalls = 0;
+
+    while (elapsedTime < BenchmarkRunTime) {
+        for (u32 callIndex = 0; callIndex < 64; callIndex++) {
+            isLegacy ? runLegacyCase(gpuCase) : runCurrentCase(gpuCase);
+        }
+
+        numberOfCalls += 64;
+        elapsedTime = DrvCpuGetTick() - startTime;
+    }
+
+    // The current driver accumulates busy time until it is synced, so it is synced outside the measurement.
+
+    if (!isLegacy) {
+        DrvGpuSync();
+    }
+
+    return (float) (numberOfCalls * casePixels[gpuCase]) / (float) elapsedTime;
+}
+
+// Benchmark ------------------------------------------------------------------
+
+bool RunGpuBenchmark(void) {
+#if defined(__AVX2__)
+    const string rowKernels = "AVX2";
+#elif defined(__SSE2__)
+    const string rowKernels = "SSE2";
+#else
+    const string rowKernels = "SWAR";
+#endif
+
+    bool hasPassed = true;
+
+    buildImages();
+
+    printf("GPU kernels (%s row kernels), pixels/us\n\n", rowKernels);
+    printf("%-14s %10s %10s %8s %6s\n", "Case", "Legacy", "Current", "Speedup", "Match");
+
+    for (GpuCase gpuCase = 0; gpuCase < NumberOfGpuCases; gpuCase++) {
+        bool  isMatching  = isCaseMatching(gpuCase);
+        float legacyRate  = measureCase(gpuCase, true);
+        float currentRate = measureCase(gpuCase, false);
+
+        printf("%-14s %10.1f %10.1f %7.2fx %6s\n", caseNames[gpuCase], legacyRate, currentRate, currentRate / legacyRate, isMatching ? "yes" : "NO");
+        hasPassed = hasPassed && isMatching;
+    }
+
+    printf("\n");
+    return hasPassed;
+}
\ No newline at end of file
@@ -7,10 +7,12 @@
 
 #include "../Packer.h"
 
-#define logTag       "Packer:Images"
-#define screenColors 256
+#include "../../Runtime/Palette.h"
 
-static u8   colorPalette[screenColors * 3];
+#define logTag "Packer:Images"
+
+static u8   colorPalette[PaletteColors * 3];
+static u8   colorLut[ColorLutSize];
 static bool isColorPaletteBuilt = false;
 
 static void buildColorPalette(void) {
@@ -18,114 +20,14 @@ static void buildColorPalette(void) {
         return;
     }
 
-    static const u8 minValues[48] = {
-        0, 0, 0,      // While/Gray/Black
-        32, 0, 0,     // Red
-        32, 8, 0,     // Red/Orange
-        32, 16, 0,    // Orange
-        32, 16, 0,    // Orange/Yellow
-        32, 32, 0,    // Yellow
-        16, 32, 0,    // Lime
-        0, 32, 0,     // Green
-        0, 32, 16,    // Green/Teal
-        0, 32, 32,    // Teal
-        0, 16, 32,    // Teal/Blue
-        0, 0, 32,     // Blue
-        8, 0, 32,     // Blue/Purple
-        16, 0, 32,    // Purple
-        32, 0, 32,    // Fuchsia
-        32, 0, 16,    // Fuchsia/Red
-    };
-
-    static const u8 midValues[48] = {
-        128, 128, 128,    // While/Gray/Black
-        255, 0, 0,        // Red
-        255, 64, 0,       // Red/Orange
-        255, 128, 0,      // Orange
-        255, 192, 0,      // Orange/Yellow
-        255, 255, 0,      // Yellow
-        128, 255, 0,      // Lime
-        0, 255, 0,        // Green
-        0, 255, 128,      // Green/Teal
-        0, 255, 255,      // Teal
-        0, 128, 255,      // Teal/Blue
-        0, 0, 255,        // Blue
-        64, 0, 255,       // Blue/Purple
-        128, 0, 255,      // Purple
-        255, 0, 255,      // Fuchsia
-        255, 0, 128,      // Fuchsia/Red
-    };
-
-    static const u8 maxValues[48] = {
-        255, 255, 255,    // While/Gray/Black
-        255, 224, 224,    // Red
-        255, 224, 224,    // Red/Orange
-        255, 240, 224,    // Orange
-        255, 255, 224,    // Orange/Yellow
-        255, 255, 224,    // Yellow
-        240, 255, 224,    // Lime
-        224, 255, 224,    // Green
-        224, 255, 240,    // Green/Teal
-        224, 255, 255,    // Teal
-        224, 240, 255,    // Teal/Blue
-        224, 224, 255,    // Blue
-        240, 224, 255,    // Blue/Purple
-        240, 224, 255,    // Purple
-        255, 224, 255,    // Fuchsia
-        255, 224, 240,    // Fuchsia/Red
-    };
-
-    uint  colorIndex = 0;
-    float redStep, greenStep, blueStep;
-
-    for (uint rowIndex = 0; rowIndex < 16; rowIndex++) {
-        redStep   = (float) (midValues[rowIndex * 3] - minValues[rowIndex * 3]) / 7.0f;
-        greenStep = (float) (midValues[rowIndex * 3 + 1] - minValues[rowIndex * 3 + 1]) / 7.0f;
-        blueStep  = (float) (midValues[rowIndex * 3 + 2] - minValues[rowIndex * 3 + 2]) / 7.0f;
-
-        for (uint columnIndex = 0; columnIndex < 8; columnIndex++) {
-            colorPalette[colorIndex * 3]     = minValues[rowIndex * 3] + floor((float) columnIndex * redStep);
-            colorPalette[colorIndex * 3 + 1] = minValues[rowIndex * 3 + 1] + floor((float) columnIndex * greenStep);
-            colorPalette[colorIndex * 3 + 2] = minValues[rowIndex * 3 + 2] + floor((float) columnIndex * blueStep);
-            colorIndex++;
-        }
-
-        redStep   = (float) (maxValues[rowIndex * 3] - midValues[rowIndex * 3]) / 8.0f;
-        greenStep = (float) (maxValues[rowIndex * 3 + 1] - midValues[rowIndex * 3 + 1]) / 8.0f;
-        blueStep  = (float) (maxValues[rowIndex * 3 + 2] - midValues[rowIndex * 3 + 2]) / 8.0f;
-
-        for (uint columnIndex = 1; columnIndex < 9; columnIndex++) {
-            colorPalette[colorIndex * 3]     = midValues[rowIndex * 3] + floor((float) columnIndex * redStep);
-            colorPalette[colorIndex * 3 + 1] = midValues[rowIndex * 3 + 1] + floor((float) columnIndex * greenStep);
-            colorPalette[colorIndex * 3 + 2] = midValues[rowIndex * 3 + 2] + floor((float) columnIndex * blueStep);
-            colorIndex++;
-        }
-    }
+    BuildColorPalette(colorPalette);
+    BuildColorLut(colorPalette, colorLut);
 
     isColorPaletteBuilt = true;
 }
 
-static u8 getNearestColorIndex(const u8 redValue, const u8 greenValue, const u8 blueValue) {
-    u8  nearestIndex    = 0;
-    int nearestDistance = INT32_MAX;
-    int colorDistance;
-
-    int redDiff, greenDiff, blueDiff;
-
-    for (uint colorIndex = 0; colorIndex < screenColors; ++colorIndex) {
-        redDiff   = colorPalette[colorIndex * 3] - redValue;
-        greenDiff = colorPalette[colorIndex * 3 + 1] - greenValue;
-        blueDiff  = colorPalette[colorIndex * 3 + 2] - blueValue;
-
-        colorDistance = (2 * redDiff * redDiff) + (4 * greenDiff * greenDiff) + (3 * blueDiff * blueDiff);
-
-        if (colorDistance < nearestDistance) {
-            nearestDistance = colorDistance;
-            nearestIndex    = colorIndex;
-        }
-    }
-
-    return nearestIndex;
+static inline u8 getNearestColorIndex(const u8 redValue, const u8 greenValue, const u8 blueValue) {
+    return colorLut[GetColorLutIndex(redValue, greenValue, blueValue)];
 }
 
 static u8 clampU8(int value) {